@@ -44,6 +44,20 @@ p_drift = 0.1; %proba to drift is p(->) = (1+3*p_drift)/4 and not to drift is p(
 %%% percolation probability: p \in [0,1]
 p_perco = 0.5; %proba to find a prey on the node (1 = always, 0 = never)
 
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%% Optional parameters (lattice engine)
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+lattice = 'default'; %'default', 'spiral', 'baseconversion', 'bitboard', 'tiles', 'shell', 'morton', 'hashset', 'window', 'sparse' or 'range'
+lattice_memory = 'heap'; %'heap', 'reserve', 'hugepage' or 'file'
+lattice_scratch_dir = '/tmp'; %directory of the lattice files ('file' storage)
+lattice_N0 = 0;          %initial number of nodes of the lattice (0: predicted from the range of the walk)
+lattice_range = 3;       %predicted range of the walk (in standard deviations of the displacement)
+lattice_growth = 1.5;    %growth factor of the side of the lattice when the walker is outside
+lattice_max_mb = 1024;   %max size of the predicted initial lattice (megabytes)
+lattice_cold_steps = 0;  %('tiles' lattice) compress the tiles not accessed for this number of steps (0: never)
+percolation_seed = 0;    %seed of the lazy percolation (0: the lattice is percolated at start)
+percolation_landscape = 'independent'; %'independent' (one landscape per simulation) or 'shared' (one landscape per value of Xs)
+
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 %% Encode to strings and generate JSON file
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
@@ -67,6 +81,17 @@ Init.power_law_xmax = string(power_law_xmax); %x_max
 Init.p_drift = string(p_drift);
 %---Percolation
 Init.p_perco = string(p_perco);
+%---Lattice engine (optional)
+Init.lattice = string(lattice);
+Init.lattice_memory = string(lattice_memory);
+Init.lattice_scratch_dir = string(lattice_scratch_dir);
+Init.lattice_N0 = string(lattice_N0);
+Init.lattice_range = string(lattice_range);
+Init.lattice_growth = string(lattice_growth);
+Init.lattice_max_mb = string(lattice_max_mb);
+Init.lattice_cold_steps = string(lattice_cold_steps);
+Init.percolation_seed = string(percolation_seed);
+Init.percolation_landscape = string(percolation_landscape);
 
 JSON = jsonencode(Init);
 fprintf(1, 'ok\n');
@@ -0,0 +1,137 @@
+/*==========================================================
+ * Bit_array (bit-packed 'visited' set used by the lattices)
+ * One bit per node/site, stored in 64-bit words.
+ * The words are either allocated on the heap (malloc/realloc),
+ * or in a reserved range of virtual memory (mmap) whose pages are committed as the array grows
+ * (optionally backed by 2 MB huge pages, or by a file for the lattices larger than the memory).
+ * The pages written since the last clear() are tracked (one bit per page of 4 KB),
+ * such that clearing the array only costs the pages actually visited by the walker.
+ *========================================================*/
+
+#ifndef BIT_ARRAY				// avoid repeated expansion
+#define BIT_ARRAY
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include <string>
+#include "config_types.hpp"
+
+//**************** Bit_array Class ****************
+class Bit_array {
+public:
+    // Where the words are stored:
+    // 'heap'    : malloc/realloc, the new words are set to 0 with memset,
+    // 'reserve' : a range of 'vm_reserve_bytes' (see Config_types.hpp) of virtual memory is reserved (mmap, PROT_NONE)
+    //             and its pages are committed (mprotect) as the array grows. Growing never copies the array,
+    //             and the new pages are zero-filled by the kernel when they are first touched (no memset).
+    // 'hugepage': same as 'reserve', but the range is aligned on 2 MB and, once the array is larger than
+    //             'hugepage_threshold', the kernel is asked for transparent huge pages (madvise(MADV_HUGEPAGE)),
+    //             which reduces the TLB misses of the random accesses. If huge pages are not available,
+    //             the standard pages are used (see huge_page_bytes()).
+    // 'file'    : same as 'reserve', but the range is a shared mapping of a sparse (and unlinked) file created in the
+    //             scratch directory (see set_scratch_dir()). The file grows with the array (ftruncate), and the kernel
+    //             (page cache) writes the pages far from the walker to the disk when the memory is short, such that
+    //             the lattice can be larger than the memory (the walk is then slower, but does not fail).
+    enum class Storage { heap, reserve, hugepage, file };
+
+    Bit_array(const bigInt, const Storage);    //Constructor (number of bits, all initialized to 0)
+    ~Bit_array();
+    Bit_array(const Bit_array &) = delete;              //no copy (owns its memory)
+    Bit_array & operator = (const Bit_array &) = delete;
+
+    void resize( const bigInt );    //grows the array, new bits are set to 0
+    void clear();                   //sets all bits to 0 (only the pages written since the last clear())
+    bigInt count() const;           //number of bits set to 1 (popcount)
+    bigInt gather( bigInt *, const bool ) const;    //collects the positions of the bits equal to 0 or 1
+    void move( const bigInt, const bigInt, const bigInt );  //moves a range of bits (the ranges can overlap)
+    void fill( const bigInt, const bigInt, const bool );    //sets a range of bits to 0 or 1
+    bool any( const bigInt, const bigInt ) const;           //is there a bit set to 1 in a range?
+    bigInt size() const;            //number of bits
+    bigInt n_words() const;         //number of 64-bit words
+    uint64_t * data();              //direct access to the words (word-level operations, see mark_dirty())
+    void mark_dirty( const bigInt, const bigInt );  //marks the bits in a range as written (words set through data())
+    const uint64_t * data() const;
+    bigInt memory_bytes() const;    //size of the words (bytes)
+    bigInt huge_page_bytes() const; //number of bytes actually backed by huge pages (see /proc/self/smaps)
+    static void set_scratch_dir( const std::string & );  //directory of the files ('file' storage)
+
+    //------------------------------------------------------------------------------
+    // Returns the bit at position 'i':
+    inline bool test( const bigInt i ) const {
+        return ( words[i >> 6] >> ( i & 63 ) ) & 1ULL;
+    }
+
+    //------------------------------------------------------------------------------
+    // Sets the bit at position 'i' to 1:
+    inline void set( const bigInt i ) {
+        words[i >> 6] |= 1ULL << ( i & 63 );
+        mark_dirty( i );
+    }
+
+    //------------------------------------------------------------------------------
+    // Sets the bit at position 'i' to 0:
+    inline void reset( const bigInt i ) {
+        words[i >> 6] &= ~( 1ULL << ( i & 63 ) );
+    }
+
+    //------------------------------------------------------------------------------
+    // Sets the bit at position 'i' to 1 and returns its previous value,
+    // i.e. returns false if the node was not visited before this call:
+    inline bool test_and_set( const bigInt i ) {
+        uint64_t & w = words[i >> 6];
+        const uint64_t mask = 1ULL << ( i & 63 );
+        const bool was_set = ( w & mask ) != 0;
+        w |= mask;
+        mark_dirty( i );
+        return was_set;
+    }
+
+private:
+    const Storage storage = Storage::heap;
+    bigInt n_bits = 0;          //number of bits
+    bigInt n_w = 0;             //number of (allocated) 64-bit words
+    bigInt committed = 0;       //number of bytes committed in the reserved range ('reserve' storage only)
+    uint64_t * words = NULL;    //the bits
+    void * map_base = NULL;     //start of the reserved range ('reserve' and 'hugepage' storages)
+    bigInt map_bytes = 0;       //size of the reserved range
+    int fd = -1;                //file descriptor of the mapped file ('file' storage)
+    static std::string scratch_dir;
+    std::vector<uint64_t> dirty;  //one bit per page of 2^dirty_page_shift bits: was the page written since the last clear()?
+    void commit( const bigInt );
+    void resize_dirty();
+
+    //------------------------------------------------------------------------------
+    // Marks the page holding the bit 'i' as written (see clear()):
+    inline void mark_dirty( const bigInt i ) {
+        const bigInt page = i >> dirty_page_shift;
+        dirty[page >> 6] |= 1ULL << ( page & 63 );
+    }
+
+    //------------------------------------------------------------------------------
+    // Returns the 'len' bits (len in [1, 64]) starting at position 'i' (in the lowest bits).
+    // The bits may span two words (the extra word allocated after 'n_w' is never read out of bounds):
+    inline uint64_t get_bits( const bigInt i, const unsigned len ) const {
+        const unsigned o = i & 63;
+        uint64_t w = words[i >> 6] >> o;
+        if( o + len > 64 )
+            w |= words[( i >> 6 ) + 1] << ( 64 - o );
+        return len == 64 ? w : w & ( ( 1ULL << len ) - 1 );
+    }
+
+    //------------------------------------------------------------------------------
+    // Writes the 'len' lowest bits of 'w' (len in [1, 64]) starting at position 'i':
+    inline void put_bits( const bigInt i, const unsigned len, const uint64_t w ) {
+        const unsigned o = i & 63;
+        const uint64_t m = len == 64 ? ~0ULL : ( 1ULL << len ) - 1;
+        uint64_t & w0 = words[i >> 6];
+        w0 = ( w0 & ~( m << o ) ) | ( ( w & m ) << o );
+        if( o + len > 64 ) {
+            uint64_t & w1 = words[( i >> 6 ) + 1];
+            w1 = ( w1 & ~( m >> ( 64 - o ) ) ) | ( ( w & m ) >> ( 64 - o ) );
+        }
+    }
+};
+
+#endif
@@ -12,11 +12,20 @@ struct Config_params
             const double p_walk_speed, const double p_walk_time, 
             const double p_p_drift, const double p_x_min_t, 
             const double p_x_max_t, const double p_gamma, 
-            const double p_p_perco, const std::vector<bigInt> Xs )
+            const double p_p_perco, const std::vector<bigInt> Xs,
+            const std::string p_lattice, const std::string p_lattice_memory,
+            const bigInt p_lattice_N0, const double p_lattice_range, 
+            const double p_lattice_growth, const double p_lattice_max_mb,
+            const bigInt p_lattice_cold_steps, const std::string p_lattice_scratch_dir,
+            const bigInt p_percolation_seed, const std::string p_percolation_landscape )
     :n_sims{ p_n_sims }, n_cores{ p_n_cores }, L_dim{ p_L_dim }, L_size{ p_L_size }, 
     end_time{ p_end_time }, walk_speed{ p_walk_speed }, walk_handling_time{ p_walk_time }, 
     p_drift{ p_p_drift }, x_min_t{ p_x_min_t }, x_max_t{ p_x_max_t }, gamma{ p_gamma },
-    p_perco{ p_p_perco }, N0s { Xs }
+    p_perco{ p_p_perco }, N0s { Xs }, lattice{ p_lattice }, lattice_memory{ p_lattice_memory },
+    lattice_N0{ p_lattice_N0 }, lattice_range{ p_lattice_range }, 
+    lattice_growth{ p_lattice_growth }, lattice_max_mb{ p_lattice_max_mb },
+    lattice_cold_steps{ p_lattice_cold_steps }, lattice_scratch_dir{ p_lattice_scratch_dir },
+    percolation_seed{ p_percolation_seed }, percolation_landscape{ p_percolation_landscape }
     {}
     
     //------------------------------------------------------------------------------
@@ -54,6 +63,50 @@ struct Config_params
             exit(EXIT_FAILURE);
         }
 
+        // (LATTICE ENGINE)
+        if( lattice != "default" && lattice != "spiral" && lattice != "baseconversion" && lattice != "bitboard" && lattice != "tiles" && lattice != "shell" && lattice != "morton" && lattice != "hashset" && lattice != "window" && lattice != "sparse" && lattice != "range" ) {
+            std::cerr << "Error: lattice = " << lattice << std::endl;
+            std::cerr << "=> make sure lattice is one of: default, spiral, baseconversion, bitboard, tiles, shell, morton, hashset, window, sparse, range." << std::endl;
+            exit(EXIT_FAILURE);
+        }
+
+        if( lattice == "spiral" && L_dim != 2 ) {
+            std::cerr << "Error: lattice = " << lattice << " with dim_lattice = " << L_dim << std::endl;
+            std::cerr << "=> the spiral lattice is only available in 2 dimensions." << std::endl;
+            exit(EXIT_FAILURE);
+        }
+
+        if( lattice_memory != "heap" && lattice_memory != "reserve" && lattice_memory != "hugepage" && lattice_memory != "file" ) {
+            std::cerr << "Error: lattice_memory = " << lattice_memory << std::endl;
+            std::cerr << "=> make sure lattice_memory is one of: heap, reserve, hugepage, file." << std::endl;
+            exit(EXIT_FAILURE);
+        }
+
+        if( lattice_range <= 0 ) {
+            std::cerr << "Error: lattice_range = " << lattice_range << std::endl;
+            std::cerr << "=> make sure lattice_range is greater than 0." << std::endl;
+            exit(EXIT_FAILURE);
+        }
+
+        if( lattice_growth <= 1 ) {
+            std::cerr << "Error: lattice_growth = " << lattice_growth << std::endl;
+            std::cerr << "=> make sure lattice_growth is greater than 1." << std::endl;
+            exit(EXIT_FAILURE);
+        }
+
+        if( lattice_max_mb <= 0 ) {
+            std::cerr << "Error: lattice_max_mb = " << lattice_max_mb << std::endl;
+            std::cerr << "=> make sure lattice_max_mb is greater than 0." << std::endl;
+            exit(EXIT_FAILURE);
+        }
+
+        // (PERCOLATION)
+        if( percolation_landscape != "independent" && percolation_landscape != "shared" ) {
+            std::cerr << "Error: percolation_landscape = " << percolation_landscape << std::endl;
+            std::cerr << "=> make sure percolation_landscape is one of: independent, shared." << std::endl;
+            exit(EXIT_FAILURE);
+        }
+
         // (Values of Xs (initial number of nodes in the lattice) )  ------------------
         for (auto i = N0s.cbegin(); i != N0s.cend(); ++i) {
             if( *i == 0 ) {
@@ -124,6 +177,20 @@ struct Config_params
         std::cout << "x_min = " << x_min_t << std::endl;
         std::cout << "x_max = " << x_max_t << std::endl;
         std::cout << "gamma = " << gamma << std::endl;
+        std::cout << "lattice = " << lattice << std::endl;
+        std::cout << "lattice memory = " << lattice_memory << std::endl;
+        if( lattice_memory == "file" )
+            std::cout << "lattice scratch dir = " << lattice_scratch_dir << std::endl;
+        if( lattice_N0 > 0 )
+            std::cout << "lattice N0 = " << lattice_N0 << std::endl;
+        else
+            std::cout << "lattice N0 = auto (range = " << lattice_range << ", max = " << lattice_max_mb << " MB)" << std::endl;
+        std::cout << "lattice growth = " << lattice_growth << std::endl;
+        if( lattice_cold_steps > 0 )
+            std::cout << "lattice cold steps = " << lattice_cold_steps << std::endl;
+        if( percolation_seed > 0 )
+            std::cout << "percolation seed = " << percolation_seed << " (lazy percolation)" << std::endl;
+        std::cout << "percolation landscape = " << percolation_landscape << std::endl;
         
         // Print N0s values:
         std::cout << "X = [ ";
@@ -132,6 +199,123 @@ struct Config_params
         std::cout << "]" << std::endl;
 
     }
+
+    //------------------------------------------------------------------------------
+    // Returns the initial number of nodes N0 of the lattice, for 'n_preys' nodes (a value of Xs)
+    // and the perturbations of the walk 'perturb' (flags, see Config_types.hpp).
+    // If lattice_N0 is given (> 0), it is used as is. Otherwise, N0 is predicted from the expected range
+    // of the walk (i.e. the max distance to the center, in nodes), such that the lattice is rarely resized:
+    // - the walker makes at most n = end_time / dt steps, where dt = L_space / walk_speed,
+    // - the displacement in each dimension has a standard deviation sigma = sqrt( n * <l^2> / (<l> * dim) ),
+    //   where l is the length of a step (l = 1 except for jumps, see get_jump_moments()),
+    // - the drift adds n * p_drift nodes in the first dimension,
+    // - the walk with memory never goes back: it is ballistic in 1D (range n),
+    //   and its variance is increased by 2d / (2d - 2) otherwise (non-reversing walk),
+    // then the range is: drift + lattice_range * sigma (the perturbations are combined).
+    // In a percolated lattice, each node of the initial lattice costs a random draw (see Lattice::percolate_init())
+    // while the nodes added later are percolated anyway, thus the range is only sigma in this case
+    // (unless the percolation is lazy, see percolation_seed).
+    bigInt get_N0( const bigInt n_preys, const unsigned perturb ) const {
+
+        if( lattice_N0 > 0 )
+            return lattice_N0;
+
+        // spacing between nodes (see Lattice::Lattice()) and number of steps:
+        const double L_space = L_dim == 1 ? L_size / ( n_preys - 1.0 ) 
+                : L_size / ( std::pow( n_preys, 1.0 / L_dim ) - 1.0 );
+        const double n_steps = end_time * walk_speed / L_space;
+
+        double drift = 0.0;                 // mean displacement (nodes)
+        double var = n_steps / L_dim;       // variance of the displacement in one dimension (nodes^2)
+        if( ( perturb & perturb_drift ) != 0 ) { // drift (the window lattice follows the drift, see Lattice_window)
+            drift = get_lattice( perturb ) == "window" ? 0.0 : p_drift * n_steps;
+            var *= ( 1.0 - p_drift );
+        }
+        if( ( perturb & perturb_jumps ) != 0 ) { // jumps (a jump of length l takes l * dt)
+            double m1 = 0.0, m2 = 0.0;
+            get_jump_moments( m1, m2 );
+            var *= m2 / m1;
+        }
+        if( ( perturb & perturb_memory ) != 0 ) { // memory (non-reversing walk)
+            if( L_dim == 1 ) {
+                drift = n_steps;
+                var = 0.0;
+            } else
+                var *= ( 2.0 * L_dim ) / ( 2.0 * L_dim - 2.0 );
+        }
+
+        // (the shared landscapes and the walks with jumps are always lazily percolated, see main_FRsim.cpp)
+        const bool percolate_at_start = ( perturb & perturb_percolation ) != 0 && ( perturb & perturb_jumps ) == 0
+                && percolation_seed == 0 && percolation_landscape != "shared";
+        const double n_sigma = percolate_at_start ? 1.0 : lattice_range;
+        const double side = 2.0 * ( drift + n_sigma * std::sqrt( var ) + 1.0 ) + 1.0;
+        return get_N0_from_side( side < 1e18 ? (bigInt) side : std::numeric_limits<bigInt>::max() );
+    }
+
+    //------------------------------------------------------------------------------
+    // Tells whether the lattice engine 'engine' stores its nodes in the bit array of the lattice (see 'Bit_array.hpp'),
+    // i.e. whether lattice_memory applies to it: the hash set, the hash of tiles and the range engines have their own
+    // storage (a hash table, or the bounds of an interval), allocated on the heap.
+    static bool uses_lattice_memory( const std::string & engine ) {
+        return engine != "hashset" && engine != "sparse" && engine != "range";
+    }
+
+    //------------------------------------------------------------------------------
+    // Returns the lattice engine used for the perturbations of the walk 'perturb' (flags, see Config_types.hpp).
+    // The default engine depends on the walk: a hash set for the walks with jumps (see Lattice_hashset),
+    // a window following the walker for the drifted walks (see Lattice_window, also with memory or percolation),
+    // a hash of tiles in 3D, where the walk visits O(n) nodes of a cube of O(n^(3/2)) nodes (see Lattice_sparse),
+    // the spiral (2D) or base conversion (1D) lattice otherwise.
+    // In 1D, the nodes visited by the walks with neighbour steps (standard, drift, memory) are an interval
+    // (see Lattice_range): the range engine is used by default, and the other walks fall back to the default engine.
+    std::string get_lattice( const unsigned perturb ) const {
+        const bool is_interval = L_dim == 1 && ( perturb & ( perturb_jumps | perturb_percolation ) ) == 0;
+        if( lattice != "default" && ( lattice != "range" || is_interval ) )
+            return lattice;
+        if( ( perturb & perturb_jumps ) != 0 )
+            return "hashset";
+        if( is_interval )
+            return "range";
+        if( ( perturb & perturb_drift ) != 0 )
+            return "window";
+        if( L_dim == 3 )
+            return "sparse";
+        return L_dim == 2 ? "spiral" : "baseconversion";
+    }
+
+    //------------------------------------------------------------------------------
+    // Returns the number of nodes of a lattice with 'side' nodes on each side,
+    // where 'side' is rounded to an odd number (the walker starts at the center node) and 
+    // bounded such that the lattice holds in lattice_max_mb megabytes (one bit per node).
+    bigInt get_N0_from_side( bigInt side ) const {
+
+        const double max_nodes = lattice_max_mb * 1024.0 * 1024.0 * 8.0;
+        const bigInt max_side = (bigInt) std::pow( max_nodes, 1.0 / L_dim );
+        side = std::min( side, max_side );
+        side = std::max( side | 1, (bigInt) 11 ); // odd, and at least 11 nodes
+
+        bigInt N0 = 1;
+        for( unsigned i = 0; i < L_dim; i++ )
+            N0 *= side;
+        return N0;
+    }
+
+    //------------------------------------------------------------------------------
+    // Computes the first and second moments <l> and <l^2> of the (discrete) power law of the jumps
+    // in [x_min, x_max] (see Power_law.cpp):
+    void get_jump_moments( double & m1, double & m2 ) const {
+        double C = 0.0;
+        m1 = 0.0;
+        m2 = 0.0;
+        for( double x = std::max( x_min_t, 1.0 ); x <= x_max_t; x++ ) {
+            const double p = std::pow( x, -gamma );
+            C += p;
+            m1 += x * p;
+            m2 += x * x * p;
+        }
+        m1 = C > 0 ? m1 / C : 1.0;
+        m2 = C > 0 ? m2 / C : 1.0;
+    }
     
     const unsigned n_sims = 1; //number of simulations
     const unsigned n_cores = 1; //number of cores to use
@@ -146,6 +330,16 @@ struct Config_params
     const double gamma = 2.0; //gamma value for the power law
     const double p_perco = 0.0; //percolation value
     const std::vector<bigInt> N0s; //vector containing the initial number of nodes (N0) for each simulation
+    const std::string lattice = "default"; //lattice engine ("default": spiral in 2D, base conversion otherwise)
+    const std::string lattice_memory = "heap"; //where the visited nodes are stored (see Bit_array.hpp)
+    const bigInt lattice_N0 = 0; //initial number of nodes in the lattice (0: predicted from the range of the walk, see get_N0())
+    const double lattice_range = 3.0; //range of the walk, in standard deviations of the displacement (see get_N0())
+    const double lattice_growth = 1.5; //growth factor of the side of the lattice when resizing (see Lattice::get_n_layers())
+    const double lattice_max_mb = 1024.0; //max size of the initial lattice (megabytes)
+    const bigInt lattice_cold_steps = 0; //age of the tiles compressed by the 'tiles' lattice (0: never, see Lattice_tiles)
+    const std::string lattice_scratch_dir = "/tmp"; //directory of the lattice files ('file' storage, see Bit_array.hpp)
+    const bigInt percolation_seed = 0; //seed of the lazy percolation (0: the lattice is percolated at start, see Landscape_lazy)
+    const std::string percolation_landscape = "independent"; //one landscape per simulation, or one shared by the simulations of a Xs value
 };
 
 #endif
\ No newline at end of file
@@ -2,7 +2,7 @@
 #define CONFIG_TYPES
 
 // This file defines:
-// (*) the types used in the simulation: bigInt, cInt, N0_1D, N0_2D, N0_3D
+// (*) the types used in the simulation: bigInt, cInt
 // (*) the precision output 
 
 //***************
@@ -28,29 +28,47 @@ using cInt = long long int;
 const static unsigned output_precision = 2;
 
 //***************
-//** Initial number of nodes (N0) in the lattice: N0_1D, N0_2D, N0_3D
-//***************
-// N0 is the initial number of nodes of the lattice, with respect to a given dimention 'd' or 'D'.
-// This number should be odd as:
-// - the walker starts at the center node of the lattice.
-// - each side is at equal distance (in terms of nodes) of the center cell
-// A ''small'' N0 value and a ''large'' 't' will value need lesser memory but will require reallocation (see Lattice::check_new_node()),
-// while a ''large'' N0 value will require more memory at the initialization but might avoid a call to (see Lattice::check_new_node()), 
-// depending on 't' and '\delta'.
-// Please note that this parameter can strongly affect the performance (ie. running time) of the simulation.
-// ---- 1D ----
-// Initial number of nodes for a 1-dimensional walk:
-const static bigInt N0_1D = 10001;
-// ---- 2D ----
-// Initial number of nodes for a 2-dimensional walk:
-// 'L_dim_size' (see Lattice.hpp) is the number of elements (nodes) in one side of the lattice.
-// In two dimensions, L_dim_size = 51 nodes ( sqrt(2601) = 51 ),
-const static bigInt N0_2D = 2601;
-// const static bigInt N0_2D = 100020001; //a higher value of N0 for 2 dimensions.
-// ---- 3D ----
-// Initial number of nodes for a 3-dimensional walk,
-// which gives a lattice side 'L_dim_size' of 101 nodes ( 3rd root of (132651) = 101 ),
-const static bigInt N0_3D = 1030301;
-// this can be further generalized to larger dimensions using nth roots.
+//** Reserved virtual memory ('reserve' storage of the lattice, see Bit_array.hpp)
+//***************
+// Size of the range of virtual memory reserved for each lattice (only the address space is reserved,
+// the pages use physical memory once they are touched). 64 GB holds 2^39 nodes (one bit per node).
+// With many threads, make sure ncores * vm_reserve_bytes fits in the address space (128 TB on x86-64).
+const static bigInt vm_reserve_bytes = 1ULL << 36;
+// The reserved range is committed (made accessible) by chunks of this size:
+const static bigInt vm_commit_bytes = 1ULL << 21;
+// ('hugepage' storage) Size of a huge page, the reserved range is aligned on this size:
+const static bigInt hugepage_bytes = 1ULL << 21;
+// ('hugepage' storage) The kernel is asked for (transparent) huge pages once the array is larger than this threshold,
+// smaller arrays use the standard pages (a huge page would waste memory):
+const static bigInt hugepage_threshold = 1ULL << 24;
+
+//***************
+//** Reset of the lattice between two simulations (see Bit_array::clear())
+//***************
+// The bits are grouped in pages of 2^dirty_page_shift bits (2^15 bits = 4 KB),
+// and only the pages written since the last reset are set to 0:
+const static unsigned dirty_page_shift = 15;
+
+//***************
+//** Percolation of the lattice (see Lattice::percolate_new())
+//***************
+// Below this probability (or above 1 - this probability), the empty nodes (or the nodes with a prey) are placed
+// by drawing the gaps between them (geometric distribution), otherwise 64 nodes are drawn at once (one word):
+const static double percolate_skip_p = 1.0 / 32;
+// The ranges of more than two chunks of this number of words are percolated in parallel (one chunk per thread):
+const static bigInt percolate_chunk_words = 1ULL << 16;
+
+//***************
+//** Perturbations of the random walk (options of the command line, see main_FRsim.cpp)
+//***************
+// The perturbations are flags, such that they can be combined (e.g. -drift -percolation), see FRsim_kernel.hpp:
+const static unsigned perturb_drift = 1;        // -drift
+const static unsigned perturb_jumps = 2;        // -jumps
+const static unsigned perturb_memory = 4;       // -memory
+const static unsigned perturb_percolation = 8;  // -percolation
+
+// Note: the initial number of nodes (N0) of the lattice is no longer hardcoded here,
+// it is predicted from the range of the walk (see Config_params::get_N0()),
+// or given in the configuration file ("lattice_N0", see README.md).
 
 #endif
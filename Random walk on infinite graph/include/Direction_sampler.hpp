@@ -0,0 +1,49 @@
+/*==========================================================
+ * Direction_sampler (direction of the steps of the walk)
+ * Draws the direction (dimension and sign) of a step to a neighbour node, uniformly among the 2*D directions.
+ * The bits of a 64-bit word of the engine are recycled: a direction costs 1 bit in 1D and 2 bits in 2D,
+ * so one call to the engine gives 64 steps in 1D and 32 steps in 2D.
+ * In 3D, the word is read as 24 digits in base 6 (6^24 < 2^64): the words larger than 3*6^24 are rejected
+ * (23% of the words), such that the digits are exactly uniform and independent, which gives 24 steps per word.
+ * (rejecting the 3-bit chunks 6 and 7 instead would give 16 steps per word, with a test at each step)
+ *========================================================*/
+
+#ifndef DIRECTION_SAMPLER				// avoid repeated expansion
+#define DIRECTION_SAMPLER
+
+#include <cstdint>
+#include <random>
+
+//**************** Direction_sampler Class ****************
+template <unsigned D>
+class Direction_sampler {
+    static_assert( D >= 1 && D <= 3, "Direction_sampler: the dimension must be 1, 2 or 3" );
+
+public:
+    //------------------------------------------------------------------------------
+    // Draws the dimension 'r_dim' (0..D-1) and the sign 'r_dir' (0: -, 1: +) of the step:
+    void draw( std::mt19937_64 & engine, int & r_dim, int & r_dir ) {
+        if( n_left == 0 ) { //all the digits of the word are used, draw a new word
+            do {
+                word = engine();
+            } while( D == 3 && word >= max_word );
+            n_left = n_digits;
+        }
+        const unsigned digit = (unsigned) ( word % base );  //a power of 2 in 1D and 2D (mask)
+        word /= base;
+        n_left--;
+
+        r_dim = (int) ( digit >> 1 );
+        r_dir = (int) ( digit & 1 );
+    }
+
+private:
+    static constexpr unsigned base = 2 * D;                             //number of directions
+    static constexpr unsigned n_digits = D == 1 ? 64 : ( D == 2 ? 32 : 24 ); //directions per word
+    static constexpr uint64_t max_word = 3 * 4738381338321616896ull;    //3*6^24 (3D only)
+
+    uint64_t word = 0;      //remaining digits of the last word drawn
+    unsigned n_left = 0;    //remaining digits in 'word'
+};
+
+#endif
@@ -5,6 +5,14 @@
 #include "Lattice.hpp"
 #include "Lattice_spiral.hpp" //in case we instanciate a spiral index (2D only)
 #include "Lattice_baseconversion.hpp" //in case we instanciate a base-changing index (nD)
+#include "Lattice_bitboard.hpp" //in case we instanciate blocks of nodes packed into words (nD)
+#include "Lattice_tiles.hpp" //in case we instanciate sparse tiles allocated on first touch (nD)
+#include "Lattice_shell.hpp" //in case we instanciate a shell index (nD)
+#include "Lattice_morton.hpp" //in case we instanciate a Z-order (Morton) index (nD)
+#include "Lattice_hashset.hpp" //in case we instanciate a hash set of the visited nodes (nD)
+#include "Lattice_window.hpp" //in case we instanciate a window growing per side (nD)
+#include "Lattice_sparse.hpp" //in case we instanciate a hash of tiles of 64 nodes (nD)
+#include "Lattice_range.hpp" //in case we instanciate an interval of visited nodes (1D)
 #include "Power_law.hpp"
 #include "Tools.hpp"
 #include "PointND.hpp"
@@ -0,0 +1,379 @@
+/*==========================================================
+ * FRsim_kernel (simulation)
+ * Architecture is:
+ * FRsim_base (Base, pure virtual) --> FRsim_kernel<D, Lat, Step, Memory, Landscape> (derived, one walk per combination)
+ * The walk is a single loop, parameterised by the type of the lattice 'Lat' and by policies
+ * (compiled for each combination of the perturbations):
+ * - Step:      how the walker moves in the direction drawn (Step_nearest, Step_drift, Step_jump),
+ * - Memory:    which directions can be drawn (Memory_none, Memory_nonreversing),
+ * - Landscape: which nodes hold a prey (Landscape_plain, Landscape_eager and Landscape_lazy for the percolation).
+ * The policies are inlined in the loop: there is no virtual call, nor test of the type of walk, at each step.
+ * The default lattice of each dimension (Lattice_range in 1D, Lattice_spiral in 2D, Lattice_sparse in 3D), and of the
+ * drifted walks (Lattice_window), and the standard lattice (Lattice_baseconversion, the default of the 1D percolation),
+ * are also called directly (final class, inlined check_new_node()); the other lattices
+ * are called through Lattice (virtual). The lattice is accessed through a cursor following the walker (Lattice_cursor).
+ * The simulations are created by make_FRsim(), from the perturbations given on the command line (see main_FRsim.cpp).
+ *========================================================*/
+
+#ifndef RANDOM_WALK_SIM_KERNEL	// avoid repeated expansion
+#define RANDOM_WALK_SIM_KERNEL
+
+#include "FRsim_base.hpp"
+#include "Direction_sampler.hpp"
+
+/*==========================================================
+ * Step policies: move the walker in the direction (r_dim, r_dir) drawn by the kernel,
+ * and return the number of edges travelled (the time of the step is this number times dt).
+ * The direction actually taken is returned in (r_dim, r_dir) (see Memory_nonreversing).
+ *========================================================*/
+//------------------------------------------------------------------------------
+// One step to a neighbour node:
+struct Step_nearest {
+    unsigned move( Walker & W, int & r_dim, int & r_dir, std::mt19937_64 & ) {
+        W.move( r_dim, r_dir );
+        return 1;
+    }
+
+    template <class Lat>
+    static bool check_new_node( Lat & L, const PointND & pt ) {
+        return L.check_new_node( &pt );
+    }
+};
+
+//------------------------------------------------------------------------------
+// One step to a neighbour node, or (with probability p_drift) in the (first) right direction (arbitrary):
+struct Step_drift {
+    explicit Step_drift( const double proba_drift ) :p_drift{ proba_drift } {}
+
+    unsigned move( Walker & W, int & r_dim, int & r_dir, std::mt19937_64 & engine ) {
+        if( rd_p( engine ) <= p_drift ) { //pick a random value and test against p_drift
+            r_dim = 0;
+            r_dir = 1;
+        }
+        W.move( r_dim, r_dir );
+        return 1;
+    }
+
+    template <class Lat>
+    static bool check_new_node( Lat & L, const PointND & pt ) {
+        return L.check_new_node( &pt );
+    }
+
+    double p_drift = 0.0;
+    std::uniform_real_distribution<> rd_p{ 0.0, 1.0 };    //for the drift probability
+};
+
+//------------------------------------------------------------------------------
+// A jump, whose length is drawn from the discrete power law 'PL' (see Power_law.cpp):
+struct Step_jump {
+    explicit Step_jump( const std::shared_ptr<Power_law> PowerLaw ) :PL{ PowerLaw } {}
+
+    unsigned move( Walker & W, int & r_dim, int & r_dir, std::mt19937_64 & engine ) {
+        const unsigned step_size = PL->rand( rd_U( engine ) );
+        W.move( r_dim, r_dir, step_size );
+        return step_size;
+    }
+
+    // the lattice grows by at least the largest jump (see Lattice::check_new_node_jump()):
+    template <class Lat>
+    static bool check_new_node( Lat & L, const PointND & pt ) {
+        return L.check_new_node_jump( &pt );
+    }
+
+    std::shared_ptr<Power_law> PL = NULL;
+    std::uniform_real_distribution<> rd_U{ 0.0, 1.0 };
+};
+
+/*==========================================================
+ * Memory policies: tell whether the direction (r_dim, r_dir) drawn is forbidden (it is then drawn again),
+ * and record the direction taken by the walker.
+ *========================================================*/
+//------------------------------------------------------------------------------
+// No memory, every direction can be drawn:
+struct Memory_none {
+    bool is_forbidden( const int, const int ) const { return false; }
+    void record( const int, const int ) {}
+};
+
+//------------------------------------------------------------------------------
+// Memory of the past site only: the walker never goes back in the direction it comes from.
+// (the memory is implemented in a loosy way, where we only keep the past direction instead of the past position,
+// see README.md)
+struct Memory_nonreversing {
+    bool is_forbidden( const int r_dim, const int r_dir ) const {
+        return r_dim == last_dim && r_dir != last_dir;
+    }
+
+    void record( const int r_dim, const int r_dir ) {
+        last_dim = r_dim;
+        last_dir = r_dir;
+    }
+
+    int last_dim = -1;  //last direction taken (-1: none, at the start of the walk)
+    int last_dir = 0;
+};
+
+/*==========================================================
+ * Landscape policies: mark the node as visited, and tell whether it was a new node holding a prey.
+ *========================================================*/
+//------------------------------------------------------------------------------
+// Every node holds a prey:
+struct Landscape_plain {
+    void init( Lattice &, std::mt19937_64 & ) {}
+
+    template <class Step, class Lat>
+    bool visit( Lat & L, const PointND & pt, std::mt19937_64 & ) const {
+        return Step::check_new_node( L, pt );
+    }
+};
+
+//------------------------------------------------------------------------------
+// Percolated lattice: the nodes of the lattice are percolated at start, and the new nodes when the lattice grows
+// (a new site can already be marked as 'visited'). Not available for the jumps (see make_FRsim()).
+struct Landscape_eager {
+    void init( Lattice & L, std::mt19937_64 & engine ) {
+        L.percolate_init( engine );
+    }
+
+    template <class Step, class Lat>
+    bool visit( Lat & L, const PointND & pt, std::mt19937_64 & engine ) const {
+        return L.check_new_node( &pt, engine );
+    }
+};
+
+//------------------------------------------------------------------------------
+// Lazy percolation: a node is empty if the hash of its coordinates and of the seed is below p_perco
+// (see Lattice::is_empty()), which is only computed the first time the walker reaches the node.
+// Nothing is percolated at start, nor when the lattice grows, and the landscape only depends on the seed.
+struct Landscape_lazy {
+    explicit Landscape_lazy( const uint64_t landscape_seed ) :seed{ landscape_seed } {}
+
+    void init( Lattice &, std::mt19937_64 & ) {}
+
+    template <class Step, class Lat>
+    bool visit( Lat & L, const PointND & pt, std::mt19937_64 & ) const {
+        return Step::check_new_node( L, pt ) && L.is_empty( pt, seed ) == false;
+    }
+
+    uint64_t seed = 0;
+};
+
+/*==========================================================
+ * Access to the lattice during the walk: by default, the node of the walker is found from its coordinates at each step
+ * (see Lattice::check_new_node()). The lattices stored row by row provide a cursor instead, whose index is updated
+ * by each step (see Lattice_window::Cursor and Lattice_baseconversion::Cursor).
+ * The spiral lattice (default in 2D) has no cursor: a step changes its index by +/-1 only along the side of a ring,
+ * and by a jump depending on the ring and the side otherwise. Telling the two cases apart is a branch taken at random
+ * by the walk, which costs more than the (branch-free) spiral index computed at each step (see get_spiral_index()).
+ *========================================================*/
+template <class Lat>
+class Lattice_cursor {
+public:
+    Lattice_cursor( Lat & lattice, const PointND & ) :L( lattice ) {}
+
+    void move( const int, const cInt ) {}
+
+    bool check_new_node( const PointND * pt ) { return L.check_new_node( pt ); }
+    bool check_new_node( const PointND * pt, std::mt19937_64 & engine ) { return L.check_new_node( pt, engine ); }
+    bool check_new_node_jump( const PointND * pt ) { return L.check_new_node_jump( pt ); }
+    bool is_empty( const PointND & pt, const uint64_t seed ) const { return L.is_empty( pt, seed ); }
+
+private:
+    Lat & L;
+};
+
+template <>
+class Lattice_cursor<Lattice_window> : public Lattice_window::Cursor {
+public:
+    using Lattice_window::Cursor::Cursor;
+};
+
+template <>
+class Lattice_cursor<Lattice_baseconversion> : public Lattice_baseconversion::Cursor {
+public:
+    using Lattice_baseconversion::Cursor::Cursor;
+};
+
+/*==========================================================
+ * FRsim_kernel: the random walk in a lattice 'Lat' of dimension D, with the policies Step, Memory and Landscape
+ *========================================================*/
+template <unsigned D, class Lat, class Step, class Memory, class Landscape>
+class FRsim_kernel : public FRsim_base {
+public:
+    FRsim_kernel(const bigInt, const double,
+            const std::shared_ptr<Lattice>,
+            const std::shared_ptr<Walker>,
+            const Step &, const Landscape &);
+    void run(bigInt &);  //run the simulation
+
+private:
+    Step step;
+    Memory memory;
+    Landscape landscape;
+};
+
+//------------------------------------------------------------------------------
+// Constructor with initialization of 'perturbated' simulations
+// (the lattice is percolated here if the landscape is percolated at start, see Landscape_eager)
+template <unsigned D, class Lat, class Step, class Memory, class Landscape>
+FRsim_kernel<D, Lat, Step, Memory, Landscape>::FRsim_kernel(const bigInt cur_n, const double end_time,
+        const std::shared_ptr<Lattice> lattice,
+        const std::shared_ptr<Walker> walker,
+        const Step & step_policy, const Landscape & landscape_policy)
+    :FRsim_base( cur_n, end_time, lattice, walker ), step{ step_policy }, landscape{ landscape_policy }
+{
+    landscape.init( *L, engine );
+}
+
+//------------------------------------------------------------------------------
+// Run the simulation (n-Dimensional random walk, with the perturbations given by the policies):
+// (D is the dimension of the lattice, 'Lat' its type, or Lattice if it is not known at compile time)
+template <unsigned D, class Lat, class Step, class Memory, class Landscape>
+void FRsim_kernel<D, Lat, Step, Memory, Landscape>::run(bigInt &cpt) {
+    double T = 0.0;   // initial time
+
+    /*****************************************************
+     * SIMULATION RUN
+     *****************************************************/
+    // the direction (dimension and sign) is drawn from the bits of the engine (see Direction_sampler.hpp):
+    Direction_sampler<D> rd_direction;
+
+    // compute the time taken to reach a node at each time step:
+    const double dt = L->get_L_space() / W->get_speed();
+
+    // set the initial position of walker------------
+    L->set_center_pos( W->loc );
+
+    // the lattice is called directly if its type is known (see make_FRsim()), through a cursor following the walker:
+    Lattice_cursor<Lat> lattice( static_cast<Lat &>( *L ), W->loc );
+
+    while(T <= time_end) {
+        // check if node (prey) is currently visited and
+        // if not, mark it as visited, otherwise do nothing
+        if( landscape.template visit<Step>( lattice, W->loc, engine ) == true ) { //this is a new node
+            cpt++; //only increase the interaction counter (number of distincts sites visited)
+            T += W->get_handling_time(); //add handling time
+        }
+
+        // draw the direction 'dir' and 'dimension' (again, if the memory forbids it):
+        int r_dim, r_dir;
+        do {
+            rd_direction.draw( engine, r_dim, r_dir );
+        } while( memory.is_forbidden( r_dim, r_dir ) );
+
+        // then move to new loc:
+        const unsigned n_edges = step.move( *W, r_dim, r_dir, engine );
+        lattice.move( r_dim, r_dir == 0 ? -(cInt) n_edges : (cInt) n_edges );
+        memory.record( r_dim, r_dir );
+        T += dt * n_edges;    //increase time taken to move to new loc (implicit conversion from unsigned to double)
+    }
+}
+
+/*==========================================================
+ * Creation of the simulations: the perturbations are dispatched once, from the step to the landscape
+ *========================================================*/
+//------------------------------------------------------------------------------
+// Landscape (plain, percolated at start, or lazy percolation if a seed is given):
+template <unsigned D, class Lat, class Memory, class Step>
+FRsim_base * make_landscape( const Step & step, const unsigned perturb,
+        const bigInt cur_n, const double end_time,
+        const std::shared_ptr<Lattice> L, const std::shared_ptr<Walker> W,
+        const uint64_t seed ) {
+
+    if( ( perturb & perturb_percolation ) == 0 )
+        return new FRsim_kernel<D, Lat, Step, Memory, Landscape_plain>( cur_n, end_time, L, W, step, Landscape_plain() );
+    if( seed != 0 )
+        return new FRsim_kernel<D, Lat, Step, Memory, Landscape_lazy>( cur_n, end_time, L, W, step, Landscape_lazy( seed ) );
+    return new FRsim_kernel<D, Lat, Step, Memory, Landscape_eager>( cur_n, end_time, L, W, step, Landscape_eager() );
+}
+
+//------------------------------------------------------------------------------
+// (Jumps) The lattices do not percolate the nodes added by a jump (see Lattice::check_new_node_jump()),
+// thus the percolation is always lazy (the seed is drawn in main_FRsim.cpp):
+template <unsigned D, class Lat, class Memory>
+FRsim_base * make_landscape( const Step_jump & step, const unsigned perturb,
+        const bigInt cur_n, const double end_time,
+        const std::shared_ptr<Lattice> L, const std::shared_ptr<Walker> W,
+        const uint64_t seed ) {
+
+    if( ( perturb & perturb_percolation ) == 0 )
+        return new FRsim_kernel<D, Lat, Step_jump, Memory, Landscape_plain>( cur_n, end_time, L, W, step, Landscape_plain() );
+    if( seed == 0 )
+        throw std::runtime_error("The percolated walks with jumps need the seed of a lazy percolation (see make_FRsim())");
+    return new FRsim_kernel<D, Lat, Step_jump, Memory, Landscape_lazy>( cur_n, end_time, L, W, step, Landscape_lazy( seed ) );
+}
+
+//------------------------------------------------------------------------------
+// Memory (none, or the past site):
+template <unsigned D, class Lat, class Step>
+FRsim_base * make_memory( const Step & step, const unsigned perturb,
+        const bigInt cur_n, const double end_time,
+        const std::shared_ptr<Lattice> L, const std::shared_ptr<Walker> W,
+        const uint64_t seed ) {
+
+    if( ( perturb & perturb_memory ) != 0 )
+        return make_landscape<D, Lat, Memory_nonreversing>( step, perturb, cur_n, end_time, L, W, seed );
+    return make_landscape<D, Lat, Memory_none>( step, perturb, cur_n, end_time, L, W, seed );
+}
+
+//------------------------------------------------------------------------------
+// Step (neighbour node, drift or jump):
+template <unsigned D, class Lat>
+FRsim_base * make_step( const unsigned perturb,
+        const bigInt cur_n, const double end_time,
+        const std::shared_ptr<Lattice> L, const std::shared_ptr<Walker> W,
+        const double p_drift, const std::shared_ptr<Power_law> PL, const uint64_t seed ) {
+
+    if( ( perturb & perturb_jumps ) != 0 )
+        return make_memory<D, Lat>( Step_jump( PL ), perturb, cur_n, end_time, L, W, seed );
+    if( ( perturb & perturb_drift ) != 0 )
+        return make_memory<D, Lat>( Step_drift( p_drift ), perturb, cur_n, end_time, L, W, seed );
+    return make_memory<D, Lat>( Step_nearest(), perturb, cur_n, end_time, L, W, seed );
+}
+
+// The walks of each dimension are compiled in their own file (FRsim_kernel_1D.cpp, ...): the compiler then inlines
+// the random draws in the loop, which it does not in a single file holding the walks of all the dimensions.
+// Each dimension is compiled for its default lattices, for the standard lattice (Lattice_baseconversion),
+// and for any lattice (Lattice, virtual calls):
+extern template FRsim_base * make_step<1, Lattice_range>( const unsigned, const bigInt, const double,
+        const std::shared_ptr<Lattice>, const std::shared_ptr<Walker>,
+        const double, const std::shared_ptr<Power_law>, const uint64_t );
+extern template FRsim_base * make_step<1, Lattice_baseconversion>( const unsigned, const bigInt, const double,
+        const std::shared_ptr<Lattice>, const std::shared_ptr<Walker>,
+        const double, const std::shared_ptr<Power_law>, const uint64_t );
+extern template FRsim_base * make_step<1, Lattice>( const unsigned, const bigInt, const double,
+        const std::shared_ptr<Lattice>, const std::shared_ptr<Walker>,
+        const double, const std::shared_ptr<Power_law>, const uint64_t );
+extern template FRsim_base * make_step<2, Lattice_spiral>( const unsigned, const bigInt, const double,
+        const std::shared_ptr<Lattice>, const std::shared_ptr<Walker>,
+        const double, const std::shared_ptr<Power_law>, const uint64_t );
+extern template FRsim_base * make_step<2, Lattice_window>( const unsigned, const bigInt, const double,
+        const std::shared_ptr<Lattice>, const std::shared_ptr<Walker>,
+        const double, const std::shared_ptr<Power_law>, const uint64_t );
+extern template FRsim_base * make_step<2, Lattice_baseconversion>( const unsigned, const bigInt, const double,
+        const std::shared_ptr<Lattice>, const std::shared_ptr<Walker>,
+        const double, const std::shared_ptr<Power_law>, const uint64_t );
+extern template FRsim_base * make_step<2, Lattice>( const unsigned, const bigInt, const double,
+        const std::shared_ptr<Lattice>, const std::shared_ptr<Walker>,
+        const double, const std::shared_ptr<Power_law>, const uint64_t );
+extern template FRsim_base * make_step<3, Lattice_sparse>( const unsigned, const bigInt, const double,
+        const std::shared_ptr<Lattice>, const std::shared_ptr<Walker>,
+        const double, const std::shared_ptr<Power_law>, const uint64_t );
+extern template FRsim_base * make_step<3, Lattice_window>( const unsigned, const bigInt, const double,
+        const std::shared_ptr<Lattice>, const std::shared_ptr<Walker>,
+        const double, const std::shared_ptr<Power_law>, const uint64_t );
+extern template FRsim_base * make_step<3, Lattice_baseconversion>( const unsigned, const bigInt, const double,
+        const std::shared_ptr<Lattice>, const std::shared_ptr<Walker>,
+        const double, const std::shared_ptr<Power_law>, const uint64_t );
+extern template FRsim_base * make_step<3, Lattice>( const unsigned, const bigInt, const double,
+        const std::shared_ptr<Lattice>, const std::shared_ptr<Walker>,
+        const double, const std::shared_ptr<Power_law>, const uint64_t );
+
+// Creates the simulation for the perturbations 'perturb' (flags, see Config_types.hpp),
+// in the dimension of the lattice:
+FRsim_base * make_FRsim( const unsigned, const bigInt, const double,
+        const std::shared_ptr<Lattice>,
+        const std::shared_ptr<Walker>,
+        const double, const std::shared_ptr<Power_law>, const uint64_t );
+
+#endif
@@ -9,27 +9,35 @@
 
 #include "config_types.hpp"
 #include "PointND.hpp"
+#include "Bit_array.hpp"
 #include "Tools.hpp"
 #include <cmath>
 #include <iostream>
 #include <cstring>
 #include <algorithm>    // std::remove
 #include <random>
+#include <vector>
 
 //**************** Lattice Class (base, pure virtual) ****************
 class Lattice {
 public:
-    Lattice(const bigInt, const bigInt, const double, const unsigned, const double, const unsigned);
+    Lattice(const bigInt, const bigInt, const double, const unsigned, const double, const unsigned, const Bit_array::Storage, const double);
     virtual bool check_new_node(const PointND *) = 0;
     virtual bool check_new_node(const PointND *, std::mt19937_64 & ) = 0;
     virtual bool check_new_node_jump(const PointND *) = 0;
     double get_L_space() const; //getter for L_space
     unsigned get_L_dim() const; //getter for L_dim
+    bigInt get_L_dim_size() const; //getter for L_dim_size
+    virtual bigInt get_memory_bytes() const; //size of the visited nodes (bytes)
+    bigInt get_huge_page_bytes() const; //bytes of the visited nodes backed by huge pages
     void set_center_pos( PointND * ) const;
     void set_center_pos( PointND & ) const;
     void print_info() const;
-    void percolate_init( std::mt19937_64 & );
+    virtual void percolate_init( std::mt19937_64 & );
     void percolate_new( const bigInt, const bigInt, std::mt19937_64 & );
+    static void set_percolate_threads( const unsigned );   //number of threads percolating a large range (see percolate_new())
+    bool is_empty( const PointND &, const uint64_t ) const;    //lazy percolation (see Landscape_lazy)
+    virtual void reset();   //marks all the nodes as not visited (new simulation), the size of the lattice is kept
     
     //------------------------------------------------------------------------------
     // Check if 'k' can hold inside the 'bigInt' type limits (i.e. if 'k' is saturated):
@@ -50,10 +58,27 @@ protected:
     const unsigned L_dim = 0;       //dim of lattice
     bigInt L_dim_size = 0;          //number of elements (nodes) in each dimension (should be const after temporary changes)
     const double L_space = 0.0;     //spacing between nodes
-    char * is_visited = NULL;       //is position in L_position already visited? ('\0' = no, '1' = yes)
+    Bit_array is_visited;           //is position in L_position already visited? (bit: 0 = no, 1 = yes)
     virtual bigInt get_index(const PointND &) const = 0;
+    unsigned get_n_layers( const unsigned ) const;  //number of layers to add when resizing the lattice
+    uint64_t percolate_word( std::mt19937_64 & ) const;    //percolates 64 nodes at once
+    void percolate_range( const bigInt, const bigInt, std::mt19937_64 & );
+    static unsigned percolate_threads;
     const double p_perco = 0.0;     //percolation (probability)
     const unsigned max_jump_size = 0;  //corresponds to the max step size when performing a jump
+    const double growth_factor = 1.5;  //growth factor of L_dim_size when resizing the lattice (see get_n_layers())
+
+    //------------------------------------------------------------------------------
+    // Mixes the bits of a key (finalizer of MurmurHash3), such that neighbouring nodes are spread over a hash table
+    // (see Lattice_hashset and Lattice_sparse):
+    static inline uint64_t hash( uint64_t k ) {
+        k ^= k >> 33;
+        k *= 0xff51afd7ed558ccdULL;
+        k ^= k >> 33;
+        k *= 0xc4ceb9fe1a85ec53ULL;
+        k ^= k >> 33;
+        return k;
+    }
 };
 
 #endif
@@ -10,21 +10,97 @@
 #include "Lattice.hpp"
 
 //**************** Lattice_baseconversion Class (derived) ****************
-class Lattice_baseconversion : public Lattice {
+class Lattice_baseconversion final : public Lattice {
+private:
+    const static unsigned max_dim = 3;  //maximal dimension of the cursor
+
 public:
-    Lattice_baseconversion(const bigInt, const bigInt, const double, const unsigned, const double, const unsigned);   //Default Constructor
+    Lattice_baseconversion(const bigInt, const bigInt, const double, const unsigned, const double, const unsigned, const Bit_array::Storage, const double);   //Default Constructor
     bool check_new_node(const PointND *);
     bool check_new_node(const PointND *, std::mt19937_64 &);
     bool check_new_node_jump(const PointND *);
 
+    //------------------------------------------------------------------------------
+    // Cursor following the walker (see FRsim_kernel): the index of the node of the walker is updated by each step
+    // (+/- 1, base or base^2, where base = 2k+1), instead of being computed from its coordinates (Horner's method).
+    // Only the coordinate of the dimension of the step is compared to [-k, k], and the index is computed again
+    // from the coordinates when the lattice grows (the base changes).
+    class Cursor {
+    public:
+        Cursor( Lattice_baseconversion & lattice, const PointND & pt ) :L( lattice ) { locate( pt ); }
+
+        //------------------------------------------------------------------------------
+        // The walker moved by 'delta' nodes in the dimension 'r_dim':
+        inline void move( const int r_dim, const cInt delta ) {
+            dim = r_dim;
+            idx += (bigInt) ( delta * stride[r_dim] );   //(modulo 2^64 if the walker is outside the lattice)
+        }
+
+        //------------------------------------------------------------------------------
+        // Check if the node of the walker 'pt' is already visited, if not, mark it as visited.
+        // If the walker is outside the lattice, the lattice grows (see Lattice_baseconversion::check_new_node()).
+        inline bool check_new_node( const PointND * pt ) {
+            if( is_outside( *pt ) ) {
+                L.grow( 1, NULL );
+                locate( *pt );
+            }
+            return L.is_visited.test_and_set( idx ) == false;
+        }
+
+        //------------------------------------------------------------------------------
+        // (Percolation version: only the new nodes are percolated)
+        inline bool check_new_node( const PointND * pt, std::mt19937_64 & engine ) {
+            if( is_outside( *pt ) ) {
+                L.grow( 1, &engine );
+                locate( *pt );
+            }
+            return L.is_visited.test_and_set( idx ) == false;
+        }
+
+        //------------------------------------------------------------------------------
+        // (Jump version: the lattice grows by at least max_jump_size layers)
+        inline bool check_new_node_jump( const PointND * pt ) {
+            if( is_outside( *pt ) ) {
+                L.grow( L.max_jump_size, NULL );
+                locate( *pt );
+            }
+            return L.is_visited.test_and_set( idx ) == false;
+        }
+
+        bool is_empty( const PointND & pt, const uint64_t seed ) const {
+            return L.is_empty( pt, seed );
+        }
+
+    private:
+        Lattice_baseconversion & L;
+        bigInt idx = 0;                         //index of the node of the walker
+        cInt stride[max_dim] = { 0, 0, 0 };     //distance between the indexes of two neighbours, in each dimension
+        int dim = 0;                            //dimension of the last step
+
+        inline bool is_outside( const PointND & pt ) const {
+            return pt[dim] < -L.k || pt[dim] > L.k;
+        }
+
+        void locate( const PointND & pt ) {
+            idx = L.get_index( pt );
+            cInt s = 1;
+            for( unsigned i = 0; i < L.L_dim && i < max_dim; i++ ) {
+                stride[i] = s;
+                s *= 2 * L.k + 1;
+            }
+        }
+    };
+
 private:
     cInt k = 0; //translation parameter when switching bases (offset)
+    void grow( const unsigned, std::mt19937_64 * );
     bigInt get_index( const PointND & ) const;
     bigInt get_n_nodes( const unsigned ) const;
     void get_n_nodes_after_jump( const PointND &, unsigned & ) const;
     void get_Point_from_index( const bigInt n, PointND & ) const;
-    void resize_lattice_vector( const unsigned, const unsigned );
-    void resize_lattice_carray( const unsigned, const unsigned );
+    void resize_lattice_vector( const bigInt, const unsigned );
+    void resize_lattice_inplace( const bigInt, const unsigned, std::mt19937_64 * );
+    void new_nodes( const bigInt, const bigInt, std::mt19937_64 * );
 };
 
 #endif
@@ -0,0 +1,52 @@
+/*==========================================================
+ * Lattice_bitboard (derived class)
+ * Architecture is:
+ * Lattice (Base, pure virtual) --> Lattice_bitboard (derived, blocks of nodes packed into 64-bit words)
+ *========================================================*/
+
+#ifndef LATTICE_BITBOARD 				// avoid repeated expansion
+#define LATTICE_BITBOARD
+
+#include <vector>
+#include "Lattice.hpp"
+
+//**************** Lattice_bitboard Class (derived) ****************
+class Lattice_bitboard final : public Lattice {
+public:
+    Lattice_bitboard(const bigInt, const bigInt, const double, const unsigned, const double, const unsigned, const Bit_array::Storage, const double);   //Default Constructor
+    bool check_new_node(const PointND *);
+    bool check_new_node(const PointND *, std::mt19937_64 &);
+    bool check_new_node_jump(const PointND *);
+    void percolate_init( std::mt19937_64 & );
+    void reset();
+
+    // Queries on the summary of the visited blocks (see update_summary()):
+    unsigned get_n_levels() const;                  //number of levels (level 0: the blocks)
+    bigInt get_cell_side( const unsigned ) const;   //number of nodes on one side of a cell of a given level
+    bool is_full( const PointND &, const unsigned ) const;      //are all the nodes of the cell (of a given level) holding the node visited?
+    bool is_untouched( const PointND &, const unsigned ) const; //is no node of the cell (of a given level) holding the node visited?
+    unsigned get_full_level( const PointND & ) const;
+
+private:
+    // A block is a 64 nodes tile stored in one word of 'is_visited':
+    // 64 nodes (1D), 8x8 nodes (2D) or 4x4x4 nodes (3D).
+    const unsigned shift = 0;   //log2 of the number of nodes on one side of a block (6, 3 or 2)
+    const cInt mask = 0;        //(number of nodes on one side of a block) - 1
+    cInt K = 0;                 //the blocks coordinates are in [-K, K] in each dimension
+    bigInt B = 0;               //number of blocks on one side of the lattice (2K+1)
+    bigInt get_index( const PointND & ) const;
+    void resize_lattice( const unsigned, std::mt19937_64 * );
+    void fill_new_blocks( const bigInt, const bigInt, std::mt19937_64 * );
+
+    // Summary of the blocks: the cells of level l (l >= 1) group 64 cells of level l-1 (64 in 1D, 8x8 in 2D, 4x4x4 in 3D),
+    // where the cells of level 0 are the blocks. For each cell, 'full[l]' holds one bit per child cell fully visited,
+    // and 'touched[l]' one bit per child cell with at least one visited node.
+    std::vector< std::vector<uint64_t> > full, touched;
+    std::vector<bigInt> level_side;     //number of cells on one side of the lattice, for each level
+    void rebuild_summary();
+    void update_summary( const PointND &, const bigInt );
+    void mark_block( cInt *, bool, bool );
+    bigInt get_cell( const PointND &, const unsigned ) const;
+};
+
+#endif
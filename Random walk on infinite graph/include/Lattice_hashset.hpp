@@ -0,0 +1,43 @@
+/*==========================================================
+ * Lattice_hashset (derived class)
+ * Architecture is:
+ * Lattice (Base, pure virtual) --> Lattice_hashset (derived, hash set of the visited nodes)
+ *========================================================*/
+
+#ifndef LATTICE_HASHSET 				// avoid repeated expansion
+#define LATTICE_HASHSET
+
+#include <cstdint>
+#include <vector>
+#ifdef __AVX2__
+#include <immintrin.h>  // _mm256_cmpeq_epi64 (compile with -mavx2 or -march=native)
+#endif
+#include "Lattice.hpp"
+
+//**************** Lattice_hashset Class (derived) ****************
+class Lattice_hashset final : public Lattice {
+public:
+    Lattice_hashset(const bigInt, const bigInt, const double, const unsigned, const double, const unsigned, const Bit_array::Storage, const double);   //Default Constructor
+    bool check_new_node(const PointND *);
+    bool check_new_node(const PointND *, std::mt19937_64 &);
+    bool check_new_node_jump(const PointND *);
+    void percolate_init( std::mt19937_64 & );
+    void reset();
+    bigInt get_memory_bytes() const;
+
+private:
+    // The visited nodes are stored in an open-addressing hash table, whose slots hold the packed coordinates
+    // of the nodes (the 'keys', 0 = empty slot). The table is probed by groups of 4 consecutive slots (32 bytes).
+    const static unsigned group = 4;        //number of slots compared at once
+    const static unsigned init_bits = 12;   //log2 of the initial number of slots
+    const unsigned key_bits = 0;            //number of bits used for each coordinate in a key (64, 32 or 21)
+    std::vector<uint64_t> table;            //the slots
+    bigInt n_keys = 0;                      //number of keys (visited nodes) in the table
+    uint64_t get_key( const PointND & ) const;
+    bigInt get_index( const PointND & ) const;
+    bigInt find_slot( const uint64_t, bool & ) const;
+    bool insert( const uint64_t, std::mt19937_64 * );
+    void grow();
+};
+
+#endif
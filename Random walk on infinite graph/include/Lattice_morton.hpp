@@ -0,0 +1,76 @@
+/*==========================================================
+ * Lattice_morton (derived class)
+ * Architecture is:
+ * Lattice (Base, pure virtual) --> Lattice_morton (derived, Z-order or Morton indexation)
+ *========================================================*/
+
+#ifndef LATTICE_MORTON 				// avoid repeated expansion
+#define LATTICE_MORTON
+
+#include <cstdint>
+#ifdef __BMI2__
+#include <immintrin.h>  // _pdep_u64 (compile with -mbmi2 or -march=native)
+#endif
+#include "Lattice.hpp"
+
+//**************** Lattice_morton Class (derived) ****************
+class Lattice_morton final : public Lattice {
+public:
+    Lattice_morton(const bigInt, const bigInt, const double, const unsigned, const double, const unsigned, const Bit_array::Storage, const double);   //Default Constructor
+    bool check_new_node(const PointND *);
+    bool check_new_node(const PointND *, std::mt19937_64 &);
+    bool check_new_node_jump(const PointND *);
+
+private:
+    unsigned side_bits = 0;     //number of bits of each coordinate code: the lattice holds 2^side_bits nodes per side
+    unsigned block_bits = 0;    //number of bits of the position in a block (2^block_bits nodes per side, see constructor)
+    bigInt get_index( const PointND & ) const;
+    unsigned get_side_bits( const PointND & ) const;
+    void resize_lattice( const unsigned, std::mt19937_64 * );
+
+    //------------------------------------------------------------------------------
+    // Maps a coordinate in Z to N (zigzag): 0, -1, 1, -2, 2, ... -> 0, 1, 2, 3, 4, ...
+    static inline uint64_t zigzag( const cInt x ) {
+        return x >= 0 ? (uint64_t) x << 1 : ( (uint64_t) ( -( x + 1 ) ) << 1 ) | 1ULL;
+    }
+
+    //------------------------------------------------------------------------------
+    // Maps a coordinate in Z to N (code): x = q*2^block_bits + r (0 <= r < 2^block_bits),
+    // code = zigzag(q)*2^block_bits + r, i.e. the blocks are in zigzag order, but the nodes of a block keep their order,
+    // such that an aligned range of 2^k codes (k <= block_bits) is a range of 2^k consecutive nodes,
+    // and the nodes with -2^(b-1) <= x < 2^(b-1) have codes in [0, 2^b) (b > block_bits):
+    inline uint64_t code( const cInt x ) const {
+        const cInt q = x >= 0 ? x >> block_bits : ~( ( ~x ) >> block_bits );   //floor( x / 2^block_bits )
+        return ( zigzag( q ) << block_bits ) | ( (uint64_t) x & ( ( 1ULL << block_bits ) - 1 ) );
+    }
+
+    //------------------------------------------------------------------------------
+    // Spreads the bits of 'v' (Morton code), i.e. inserts (dim-1) zeros between two consecutive bits:
+    // 2D: bit i -> bit 2i (32 bits), 3D: bit i -> bit 3i (21 bits).
+    static inline uint64_t spread( uint64_t v, const unsigned dim ) {
+#ifdef __BMI2__
+        // parallel bits deposit (one instruction):
+        return dim == 2 ? _pdep_u64( v, 0x5555555555555555ULL )
+             : ( dim == 3 ? _pdep_u64( v, 0x9249249249249249ULL ) : v );
+#else
+        if( dim == 2 ) {
+            v &= 0x00000000FFFFFFFFULL;
+            v = ( v | ( v << 16 ) ) & 0x0000FFFF0000FFFFULL;
+            v = ( v | ( v << 8 ) )  & 0x00FF00FF00FF00FFULL;
+            v = ( v | ( v << 4 ) )  & 0x0F0F0F0F0F0F0F0FULL;
+            v = ( v | ( v << 2 ) )  & 0x3333333333333333ULL;
+            v = ( v | ( v << 1 ) )  & 0x5555555555555555ULL;
+        } else if( dim == 3 ) {
+            v &= 0x00000000001FFFFFULL;
+            v = ( v | ( v << 32 ) ) & 0x001F00000000FFFFULL;
+            v = ( v | ( v << 16 ) ) & 0x001F0000FF0000FFULL;
+            v = ( v | ( v << 8 ) )  & 0x100F00F00F00F00FULL;
+            v = ( v | ( v << 4 ) )  & 0x10C30C30C30C30C3ULL;
+            v = ( v | ( v << 2 ) )  & 0x1249249249249249ULL;
+        }
+        return v;
+#endif
+    }
+};
+
+#endif
@@ -0,0 +1,46 @@
+/*==========================================================
+ * Lattice_range (derived class)
+ * Architecture is:
+ * Lattice (Base, pure virtual) --> Lattice_range (derived, interval of the visited nodes, 1D only)
+ *========================================================*/
+
+#ifndef LATTICE_RANGE 				// avoid repeated expansion
+#define LATTICE_RANGE
+
+#include "Lattice.hpp"
+
+//**************** Lattice_range Class (derived) ****************
+// (final: the walks in 1D call check_new_node() without a virtual call, and inline it, see FRsim_kernel)
+class Lattice_range final : public Lattice {
+public:
+    Lattice_range(const bigInt, const bigInt, const double, const unsigned, const double, const unsigned, const Bit_array::Storage, const double);   //Default Constructor
+
+    //------------------------------------------------------------------------------
+    // Check if node is already visited, if not, mark it as visited.
+    // The walker is at most one node away from the interval (neighbour steps), thus it is new if it is outside.
+    inline bool check_new_node(const PointND * pt) {
+        const cInt x = (*pt)[0];
+        if( x < lo )
+            lo = x;
+        else if( x > hi )
+            hi = x;
+        else
+            return false;
+
+        nodes = hi - lo + 1;
+        L_dim_size = nodes;
+        return true;
+    }
+
+    bool check_new_node(const PointND *, std::mt19937_64 &);
+    bool check_new_node_jump(const PointND *);
+    void reset();
+    bigInt get_memory_bytes() const;
+
+private:
+    cInt lo = 0;    //the visited nodes are [lo, hi] (none if hi < lo)
+    cInt hi = -1;
+    bigInt get_index( const PointND & ) const;
+};
+
+#endif
@@ -0,0 +1,28 @@
+/*==========================================================
+ * Lattice_shell (derived class)
+ * Architecture is:
+ * Lattice (Base, pure virtual) --> Lattice_shell (derived, shell or 'onion' indexation)
+ *========================================================*/
+
+#ifndef LATTICE_SHELL 				// avoid repeated expansion
+#define LATTICE_SHELL
+
+#include "Lattice.hpp"
+#include "Lattice_spiral.hpp" //spiral index (2D), also used for the shells in 3D
+
+//**************** Lattice_shell Class (derived) ****************
+class Lattice_shell final : public Lattice {
+public:
+    Lattice_shell(const bigInt, const bigInt, const double, const unsigned, const double, const unsigned, const Bit_array::Storage, const double);   //Default Constructor
+    bool check_new_node(const PointND *);
+    bool check_new_node(const PointND *, std::mt19937_64 &);
+    bool check_new_node_jump(const PointND *);
+
+private:
+    cInt R = 0; //radius of the lattice: it holds all the nodes with max(|x|, |y|, |z|) <= R
+    bigInt get_index( const PointND & ) const;
+    cInt get_radius( const PointND & ) const;
+    void resize_lattice( const cInt, std::mt19937_64 * );
+};
+
+#endif
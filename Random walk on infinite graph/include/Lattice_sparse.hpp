@@ -0,0 +1,134 @@
+/*==========================================================
+ * Lattice_sparse (derived class)
+ * Architecture is:
+ * Lattice (Base, pure virtual) --> Lattice_sparse (derived, hash of 64 nodes tiles behind a Bloom filter)
+ *========================================================*/
+
+#ifndef LATTICE_SPARSE 				// avoid repeated expansion
+#define LATTICE_SPARSE
+
+#include <cstdint>
+#include <vector>
+#include "Lattice.hpp"
+
+//**************** Lattice_sparse Class (derived) ****************
+// (final: the walks in 3D call check_new_node() without a virtual call, and inline it, see FRsim_kernel)
+class Lattice_sparse final : public Lattice {
+public:
+    Lattice_sparse(const bigInt, const bigInt, const double, const unsigned, const double, const unsigned, const Bit_array::Storage, const double);   //Default Constructor
+
+    //------------------------------------------------------------------------------
+    // Check if node is already visited, if not, mark it as visited.
+    inline bool check_new_node(const PointND * pt) {
+        return visit( *pt, NULL );
+    }
+
+    //------------------------------------------------------------------------------
+    // (Percolation version: the nodes of a tile are percolated when the tile is added, see new_tile())
+    inline bool check_new_node(const PointND * pt, std::mt19937_64 & engine) {
+        return visit( *pt, &engine );
+    }
+
+    //------------------------------------------------------------------------------
+    // (Jump version: the table does not depend on the length of the jump)
+    inline bool check_new_node_jump(const PointND * pt) {
+        return visit( *pt, NULL );
+    }
+
+    void percolate_init( std::mt19937_64 & );
+    void reset();
+    bigInt get_memory_bytes() const;
+
+private:
+    // A tile holds 64 nodes in one word: 64 (1D), 8x8 (2D) or 4x4x4 (3D) nodes (as the blocks of Lattice_bitboard).
+    // The tiles are stored in an open-addressing hash table, keyed by the packed coordinates of the tile (0 = empty slot).
+    // The slots are grouped by 4 in a cache line of 64 bytes (4 keys, then their 4 tiles), and a group is probed at once.
+    struct Group {
+        uint64_t key[4];
+        uint64_t tile[4];
+    };
+    const static unsigned group = 4;        //number of slots in a group
+    const static unsigned init_bits = 10;   //log2 of the initial number of groups
+    const unsigned shift = 0;               //log2 of the number of nodes on one side of a tile (6, 3 or 2)
+    const cInt mask = 0;                    //(number of nodes on one side of a tile) - 1
+    const unsigned key_bits = 0;            //number of bits used for each tile coordinate in a key (64, 32 or 21)
+    std::vector<uint64_t> storage;          //memory of the table (a group is aligned on a cache line inside)
+    Group * table = NULL;                   //the groups of slots
+    bigInt n_groups = 0;                    //number of groups (a power of 2)
+    bigInt n_tiles = 0;                     //number of tiles (keys) in the table
+    uint64_t last_key = 0;                  //key of the last tile accessed (cache, 0: none)
+    uint64_t * last_tile = NULL;            //last tile accessed
+
+    // Blocked Bloom filter of the keys: a key sets 'n_probes' bits in a single block of 512 bits (one cache line),
+    // such that a tile not in the table (a new tile, the frequent case at the front of a transient walk)
+    // is known after one cache line, and the table is only probed to insert it.
+    const static unsigned n_probes = 4;     //number of bits set by a key
+    const static unsigned bloom_ratio = 64; //number of slots of the table per block of the filter (8 bits per slot)
+    std::vector<uint64_t> bloom;            //the blocks (8 words each)
+    bigInt n_blocks = 0;                    //number of blocks (a power of 2)
+
+    void check_key( const PointND & ) const;
+    bigInt get_index( const PointND & ) const;
+    void enter_tile( const PointND &, const uint64_t, std::mt19937_64 * );
+    uint64_t * find_tile( const uint64_t, const uint64_t );
+    uint64_t * new_tile( const uint64_t, const uint64_t, std::mt19937_64 * );
+    bigInt find_slot( const uint64_t, const uint64_t, bool & ) const;
+    void allocate( const bigInt );
+    void grow();
+    bool bloom_test( const uint64_t ) const;
+    void bloom_add( const uint64_t );
+
+    //------------------------------------------------------------------------------
+    // Returns the bits of the probes of the hash 'h' in its block of the filter (9 bits per probe, in the lowest bits):
+    // the high bits of h * (golden ratio), which depend on all the bits of 'h', whereas the bits of 'h' itself
+    // also give the group (low bits) and the block (high bits) of the key.
+    static inline uint64_t bloom_probes( const uint64_t h ) {
+        return ( h * 0x9E3779B97F4A7C15ULL ) >> ( 64 - 9 * n_probes );
+    }
+
+    //------------------------------------------------------------------------------
+    // Marks the node 'pt' as visited and returns true if it was not visited before.
+    // Most steps stay in the last tile accessed (a single word), the other tiles are found by enter_tile().
+    // If 'engine' is not NULL, the nodes of a new tile are percolated (see new_tile()).
+    inline bool visit( const PointND & pt, std::mt19937_64 * engine ) {
+
+        const uint64_t key = get_key( pt );
+        if( key != last_key )
+            enter_tile( pt, key, engine );
+
+        const uint64_t m = 1ULL << get_bit( pt );
+        if( ( *last_tile & m ) != 0 )
+            return false;
+        *last_tile |= m;
+        return true;
+    }
+
+    //------------------------------------------------------------------------------
+    // Returns the key of the tile holding the node 'pt', i.e. the coordinates of the tile packed into 64 bits
+    // (64, 32 or 21 bits per coordinate).
+    // The coordinates are shifted by 2^(key_bits-1), such that no tile has the key 0 (empty slot).
+    // The range of the coordinates is checked when the walker enters another tile (see check_key()).
+    inline uint64_t get_key( const PointND & pt ) const {
+
+        if( key_bits == 64 )
+            return (uint64_t) ( pt[0] >> shift ) ^ ( 1ULL << 63 );
+
+        const cInt half = (cInt) 1 << ( key_bits - 1 );
+        uint64_t key = 0;
+        for( unsigned i = 0; i < L_dim; i++ )
+            key = ( key << key_bits ) | (uint64_t) ( ( pt[i] >> shift ) + half );
+        return key;
+    }
+
+    //------------------------------------------------------------------------------
+    // Returns the position of the node 'pt' in its tile: x + 8y (2D), x + 4y + 16z (3D)
+    inline unsigned get_bit( const PointND & pt ) const {
+
+        unsigned bit = 0;
+        for( unsigned i = 0; i < L_dim; i++ )
+            bit |= (unsigned) ( pt[i] & mask ) << ( shift * i );
+        return bit;
+    }
+};
+
+#endif
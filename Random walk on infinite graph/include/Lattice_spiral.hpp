@@ -10,16 +10,74 @@
 #include "Lattice.hpp"
 
 //**************** Lattice_spiral Class (derived) ****************
-class Lattice_spiral : public Lattice {
+// (final: the walks on a spiral lattice call check_new_node() without a virtual call, and inline it, see FRsim_kernel)
+class Lattice_spiral final : public Lattice {
 public:
-    Lattice_spiral(const bigInt, const bigInt, const double, const unsigned, const double, const unsigned);   //Default Constructor
-    bool check_new_node(const PointND *); //default search for a 'new' node (= is this site already visited?)
-    bool check_new_node(const PointND *, std::mt19937_64 &); //alternative seach including percolation
-    bool check_new_node_jump(const PointND *); //alternative seach including a jumping walker, which requires on-the-fly relallocation      
+    Lattice_spiral(const bigInt, const bigInt, const double, const unsigned, const double, const unsigned, const Bit_array::Storage, const double);   //Default Constructor
+
+    //------------------------------------------------------------------------------
+    // Check if node is already visited (2D only), if not, mark it as visited.
+    // We also check the node is inside the lattice, otherwise we increase its size (see grow()).
+    inline bool check_new_node(const PointND * pt) { //default search for a 'new' node (= is this site already visited?)
+        const bigInt idx = get_index( *pt );
+        if( idx >= nodes )
+            grow( 1, NULL );
+
+        // (test_and_set() marks the node as visited and returns its previous state):
+        return is_visited.test_and_set( idx ) == false;
+    }
+
+    //------------------------------------------------------------------------------
+    // (Percolation version: the new nodes are percolated when the lattice grows,
+    // thus a new site can already be marked as 'visited')
+    inline bool check_new_node(const PointND * pt, std::mt19937_64 & engine) { //alternative seach including percolation
+        const bigInt idx = get_index( *pt );
+        if( idx >= nodes )
+            grow( 1, &engine );
+        return is_visited.test_and_set( idx ) == false;
+    }
+
+    //------------------------------------------------------------------------------
+    // (Jump version: the walker is at most max_jump_size layers outside the lattice)
+    inline bool check_new_node_jump(const PointND * pt) { //alternative seach including a jumping walker, which requires on-the-fly relallocation
+        const bigInt idx = get_index( *pt );
+        if( idx >= nodes )
+            grow( max_jump_size, NULL );
+        return is_visited.test_and_set( idx ) == false;
+    }
+
+    //------------------------------------------------------------------------------
+    // returns index from a spiral (2D only), also used by Lattice_shell:
+    // adapted from: https://stackoverflow.com/questions/9970134/get-spiral-index-from-location
+    // The nodes of the ring (or layer) 'r' = max(|x|, |y|) have indexes in [(2r-1)^2, (2r+1)^2),
+    // thus adding rings to the lattice only appends new indexes.
+    static inline unsigned long long int get_spiral_index(const cInt x, const cInt y) {
+
+        unsigned long long int p = 0;
+
+        if( y * y >= x * x ) {
+            p = 4 * y * y - y - x;
+            if ( y < x )
+                p = p - 2 * ( y - x );
+        } else {
+            p = 4 * x * x - y - x;
+            if ( y < x )
+                p = p + 2 *( y - x );
+        }
+
+        return p;
+    }
 
 private:
     bigInt get_n_nodes(const bigInt) const;
-    bigInt get_index(const PointND &) const;
+    void grow( const unsigned, std::mt19937_64 * );
+
+    //------------------------------------------------------------------------------
+    // returns index from a spiral (2D only).
+    // The index always fits in a 'bigInt', as the side of the lattice is checked when it grows (see grow()):
+    inline bigInt get_index(const PointND &pt) const {
+        return (bigInt) get_spiral_index( pt[0], pt[1] );
+    }
 };
 
 #endif
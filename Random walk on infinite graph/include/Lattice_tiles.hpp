@@ -0,0 +1,68 @@
+/*==========================================================
+ * Lattice_tiles (derived class)
+ * Architecture is:
+ * Lattice (Base, pure virtual) --> Lattice_tiles (derived, sparse tiles allocated on first touch)
+ *========================================================*/
+
+#ifndef LATTICE_TILES 				// avoid repeated expansion
+#define LATTICE_TILES
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "Lattice.hpp"
+
+//**************** Lattice_tiles Class (derived) ****************
+class Lattice_tiles final : public Lattice {
+public:
+    Lattice_tiles(const bigInt, const bigInt, const double, const unsigned, const double, const unsigned, const Bit_array::Storage, const double, const bigInt);   //Default Constructor
+    bool check_new_node(const PointND *);
+    bool check_new_node(const PointND *, std::mt19937_64 &);
+    bool check_new_node_jump(const PointND *);
+    void reset();
+    bigInt get_n_compressed() const;    //number of tiles compressed (cold tiles)
+    bigInt get_n_decompressed() const;  //number of cold tiles decompressed (accessed again)
+    bigInt get_cold_bytes() const;      //size of the compressed tiles (bytes)
+
+private:
+    // A tile holds 4096 nodes: 4096 (1D), 64x64 (2D) or 16x16x16 (3D) nodes.
+    // The tiles are stored one after the other in 'is_visited' (the 'pool' of tiles),
+    // and 'directory' maps the coordinates of a tile to its position (slot) in the pool.
+    const static unsigned tile_bits = 12;   //log2 of the number of nodes in a tile
+    const unsigned shift = 0;               //log2 of the number of nodes on one side of a tile (12, 6 or 4)
+    const cInt mask = 0;                    //(number of nodes on one side of a tile) - 1
+    const unsigned key_bits = 0;            //number of bits used for each tile coordinate in a key
+    std::unordered_map<uint64_t, bigInt> directory; //tile key -> slot in the pool
+    bigInt n_tiles = 0;                     //number of tiles in use (the capacity of the pool is nodes / 4096)
+    uint64_t last_key = 0;                  //key of the last tile accessed (cache)
+    bigInt last_slot = 0;                   //slot of the last tile accessed (cache)
+    bool has_last = false;                  //is the cache valid?
+    uint64_t get_key( const PointND & ) const;
+    bigInt get_node( const PointND &, std::mt19937_64 * );
+    bigInt get_index( const PointND & ) const;
+    bigInt new_tile( const uint64_t, std::mt19937_64 * );
+    bigInt new_slot( std::mt19937_64 * );
+
+    // Cold tiles: a tile that was not accessed for 'cold_steps' steps is compressed (see compress()),
+    // and its slot in the pool is given to the next new tile. It is decompressed the next time the walker enters it.
+    // A compressed tile is either a list of runs of visited nodes (pairs start, length - 1),
+    // a list of visited nodes, or a copy of the 64 words (whichever is the smallest).
+    enum class Container : uint8_t { runs, array, bitmap };
+    struct Cold_tile {
+        Container type;
+        std::vector<uint16_t> data;
+    };
+    const bigInt cold_steps = 0;            //age (number of steps) of a cold tile (0: tiles are never compressed)
+    bigInt clock = 0;                       //number of steps (calls to get_node())
+    bigInt next_sweep = 0;                  //next search of the cold tiles (clock)
+    std::vector<bigInt> last_use;           //last access (clock) of the tile in each slot
+    std::vector<uint64_t> slot_key;         //key of the tile in each slot
+    std::vector<bigInt> free_slots;         //slots of the compressed tiles (available for new tiles)
+    std::unordered_map<uint64_t, Cold_tile> cold;   //tile key -> compressed tile
+    bigInt n_compressed = 0, n_decompressed = 0, cold_bytes = 0;
+    void sweep();
+    void compress( const bigInt );
+    void decompress( const Cold_tile &, const bigInt );
+};
+
+#endif
@@ -0,0 +1,103 @@
+/*==========================================================
+ * Lattice_window (derived class)
+ * Architecture is:
+ * Lattice (Base, pure virtual) --> Lattice_window (derived, window growing per axis and per side)
+ *========================================================*/
+
+#ifndef LATTICE_WINDOW 				// avoid repeated expansion
+#define LATTICE_WINDOW
+
+#include "Lattice.hpp"
+
+//**************** Lattice_window Class (derived) ****************
+class Lattice_window final : public Lattice {
+private:
+    const static unsigned max_dim = 3;  //maximal dimension of the window
+
+public:
+    Lattice_window(const bigInt, const bigInt, const double, const unsigned, const double, const unsigned, const Bit_array::Storage, const double);   //Default Constructor
+    bool check_new_node(const PointND *);
+    bool check_new_node(const PointND *, std::mt19937_64 &);
+    bool check_new_node_jump(const PointND *);
+
+    //------------------------------------------------------------------------------
+    // Cursor following the walker (see FRsim_kernel): the index of the node of the walker is updated by each step
+    // (+/- the stride of the dimension of the step), instead of being computed from its coordinates.
+    // Only the coordinate of the dimension of the step is compared to the window, and the index is computed again
+    // from the coordinates when the window grows (the strides change).
+    class Cursor {
+    public:
+        Cursor( Lattice_window & lattice, const PointND & pt ) :L( lattice ) { locate( pt ); }
+
+        //------------------------------------------------------------------------------
+        // The walker moved by 'delta' nodes in the dimension 'r_dim':
+        inline void move( const int r_dim, const cInt delta ) {
+            dim = r_dim;
+            idx += (bigInt) ( delta * stride[r_dim] );   //(modulo 2^64 if the walker is outside the window)
+        }
+
+        //------------------------------------------------------------------------------
+        // Check if the node of the walker 'pt' is already visited, if not, mark it as visited.
+        // If the walker is outside the window, the window grows (see Lattice_window::check_new_node()).
+        inline bool check_new_node( const PointND * pt ) {
+            if( is_outside( *pt ) ) {
+                L.resize_window( *pt, 1, NULL );
+                locate( *pt );
+            }
+            return L.is_visited.test_and_set( idx ) == false;
+        }
+
+        //------------------------------------------------------------------------------
+        // (Percolation version: only the new nodes are percolated)
+        inline bool check_new_node( const PointND * pt, std::mt19937_64 & engine ) {
+            if( is_outside( *pt ) ) {
+                L.resize_window( *pt, 1, &engine );
+                locate( *pt );
+            }
+            return L.is_visited.test_and_set( idx ) == false;
+        }
+
+        //------------------------------------------------------------------------------
+        // (Jump version: the window grows by at least max_jump_size nodes)
+        inline bool check_new_node_jump( const PointND * pt ) {
+            if( is_outside( *pt ) ) {
+                L.resize_window( *pt, L.max_jump_size, NULL );
+                locate( *pt );
+            }
+            return L.is_visited.test_and_set( idx ) == false;
+        }
+
+        bool is_empty( const PointND & pt, const uint64_t seed ) const {
+            return L.is_empty( pt, seed );
+        }
+
+    private:
+        Lattice_window & L;
+        bigInt idx = 0;                         //index of the node of the walker
+        cInt stride[max_dim] = { 0, 0, 0 };     //distance between the indexes of two neighbours, in each dimension
+        int dim = 0;                            //dimension of the last step
+
+        inline bool is_outside( const PointND & pt ) const {
+            return pt[dim] < L.lo[dim] || pt[dim] > L.hi[dim];
+        }
+
+        void locate( const PointND & pt ) {
+            idx = L.get_index( pt );
+            cInt s = 1;
+            for( unsigned i = 0; i < L.L_dim; i++ ) {
+                stride[i] = s;
+                s *= (cInt) L.side[i];
+            }
+        }
+    };
+
+private:
+    cInt lo[max_dim] = { 0, 0, 0 };     //the window holds the nodes with lo[i] <= x[i] <= hi[i] in each dimension 'i'
+    cInt hi[max_dim] = { 0, 0, 0 };
+    bigInt side[max_dim] = { 1, 1, 1 }; //number of nodes in each dimension (hi - lo + 1)
+    bigInt get_index( const PointND & ) const;
+    void resize_window( const PointND &, const unsigned, std::mt19937_64 * );
+    void new_nodes( const bigInt, const bigInt, std::mt19937_64 * );
+};
+
+#endif
@@ -4,9 +4,15 @@
 #include<array>
 #include<iostream>
 #include<limits>
+#include<stdexcept>
 #include "config_types.hpp"
 
 //**************** PointND class ****************
+// The dimension of a point is a runtime value (at most max_dim), not a template parameter: PointND is the type taken
+// by the interface of all the lattices (see Lattice.hpp), including the lattices called through Lattice (virtual).
+// The walk itself is compiled for each dimension (FRsim_kernel<D, ...>), and a step only changes one coordinate
+// (see Walker::move()). The loops over the dimension left are those of the lattices finding a node from its
+// coordinates, which the lattices stored row by row avoid with a cursor (see Lattice_cursor in FRsim_kernel.hpp).
 class PointND
 {
     public:
@@ -20,22 +26,17 @@ class PointND
 
     //------------------------------------------------------------------------------
     // Specific constructor for all dimensions with infinity.
-    // we use infinity to show that the walker has not yet be initialized in the simulation (see FRsim).
+    // we use infinity to show that the walker has not yet be initialized in the simulation (see FRsim_kernel).
+    // The coordinates are stored in the point itself (no allocation), thus the dimension is at most max_dim.
     PointND( const unsigned int dim )
     :nDimensions{ dim }
     {
-        elements_ = (cInt*) malloc(dim * sizeof(cInt));
-        std::fill_n(elements_, nDimensions, std::numeric_limits<cInt>::infinity());
+        if( dim > max_dim )
+            throw std::runtime_error("PointND: the dimension must be in [1, 3]");
+        elements_.fill( std::numeric_limits<cInt>::infinity() );
         //std::cout << "=> je suis cre avec 2 dimensions\n";
     }
 
-    //------------------------------------------------------------------------------
-    // Destructor
-    ~PointND() {
-        //std::cout << "=> je suis detruit\n";
-        free( elements_ );
-    }
-
     //------------------------------------------------------------------------------
     // returns the number of dimensions
     unsigned int n_dim() const {
@@ -110,9 +111,11 @@ class PointND
         return out;
     }
     
+    const static unsigned int max_dim = 3; //maximal number of dimensions (see Config_params::assert_params_values())
+
     private:
     const unsigned int nDimensions = 2; //default number of Dimensions is 2
-    cInt * elements_ = NULL;
+    std::array<cInt, max_dim> elements_ {}; //coordinates (only the first nDimensions are used)
 };
 
 #endif
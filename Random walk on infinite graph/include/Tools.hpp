@@ -26,6 +26,7 @@ public:
     static int json_to_int(const nlohmann::json&);
     static unsigned json_to_uint(const nlohmann::json&);
     static bigInt json_to_bigInt(const nlohmann::json&);
+    static std::string json_to_string(const nlohmann::json&);
     static void print_info(const nlohmann::json&);
     static int fcompare(const double, const double);
     static bool is_integer( const double );
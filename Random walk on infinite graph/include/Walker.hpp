@@ -7,13 +7,12 @@
 
 class Walker {
 public:
-    PointND *loc = NULL; //current location
+    PointND loc; //current location (stored in the walker, see PointND)
 
     Walker( const double, const double, const unsigned ); //Constructor
-    void move( PointND * );
+    void move( const PointND & );
     void move( const int, const int );
     void move( const int, const int, const unsigned );
-    void move( const int, const int, const char );
     void print_loc() const;
     double get_speed() const;
     double get_handling_time() const;
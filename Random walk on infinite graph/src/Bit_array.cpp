@@ -0,0 +1,335 @@
+/*==========================================================
+ * Bit_array (bit-packed 'visited' set used by the lattices)
+ *========================================================*/
+#include <stdexcept>
+#include <algorithm>
+#include <fstream>
+#include <string>
+#include <cstdio>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/statvfs.h>
+#include "Bit_array.hpp"
+
+std::string Bit_array::scratch_dir = "/tmp";
+
+//------------------------------------------------------------------------------
+// Sets the directory where the files of the 'file' storage are created (it should be on a local disk):
+void Bit_array::set_scratch_dir( const std::string & dir ) {
+    scratch_dir = dir;
+}
+
+//------------------------------------------------------------------------------
+// Constructor: allocates 'n' bits, all initialized to 0.
+Bit_array::Bit_array( const bigInt n, const Storage where )
+    :storage{ where }, n_bits{ n }, n_w{ ( n + 63 ) >> 6 }
+{
+    if( storage == Storage::heap ) {
+        words = (uint64_t *) calloc( n_w + 1, sizeof(uint64_t) ); // +1: never malloc(0)
+        if( words == NULL )
+            throw std::runtime_error("Bit_array: cannot allocate the lattice (out of memory)");
+    } else if( storage == Storage::file ) {
+        // create a temporary file, removed at once from the directory: its blocks are released when it is closed
+        // (see the destructor), even if the simulation is killed. The file is sparse: the blocks are allocated on the
+        // disk only when the pages are written.
+        std::string name = scratch_dir + "/frsim_lattice_XXXXXX";
+        fd = mkstemp( &name[0] );
+        if( fd < 0 )
+            throw std::runtime_error("Bit_array: cannot create the lattice file in " + scratch_dir + " (see lattice_scratch_dir)");
+        unlink( name.c_str() );
+
+        // the whole range is mapped at once (the pages above the end of the file are never accessed, see commit()):
+        map_bytes = vm_reserve_bytes;
+        map_base = mmap( NULL, map_bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 );
+        if( map_base == MAP_FAILED ) {
+            close( fd );
+            throw std::runtime_error("Bit_array: cannot map the lattice file (see vm_reserve_bytes in Config_types.hpp)");
+        }
+        // the walker only accesses the pages around its position: no read-ahead of the file
+        madvise( map_base, map_bytes, MADV_RANDOM );
+        words = (uint64_t *) map_base;
+        commit( ( n_w + 1 ) * sizeof(uint64_t) );
+    } else {
+        // reserve the address space only: no physical memory, nor swap, is used at this stage.
+        // ('hugepage' storage: we reserve one more huge page, such that the words start on a 2 MB boundary)
+        const bigInt align = storage == Storage::hugepage ? hugepage_bytes : 0;
+        map_bytes = vm_reserve_bytes + align;
+        map_base = mmap( NULL, map_bytes, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0 );
+        if( map_base == MAP_FAILED )
+            throw std::runtime_error("Bit_array: cannot reserve the virtual memory (see vm_reserve_bytes in Config_types.hpp)");
+
+        uintptr_t start = (uintptr_t) map_base;
+        if( align > 0 )
+            start = ( start + align - 1 ) & ~( (uintptr_t) align - 1 );
+        words = (uint64_t *) start;
+        commit( ( n_w + 1 ) * sizeof(uint64_t) );
+    }
+    resize_dirty();
+}
+
+//------------------------------------------------------------------------------
+// Resizes the map of the written pages to the current number of words (the new pages are clean).
+void Bit_array::resize_dirty() {
+    const bigInt page_words = 1ULL << ( dirty_page_shift - 6 );
+    const bigInt n_pages = ( n_w + 1 + page_words - 1 ) / page_words; //(+1: the extra word)
+    dirty.resize( ( n_pages + 63 ) >> 6, 0 );
+}
+
+//------------------------------------------------------------------------------
+// Marks the pages holding the bits in [start, end) as written (see clear()):
+void Bit_array::mark_dirty( const bigInt start, const bigInt end ) {
+    if( start >= end )
+        return;
+    for( bigInt page = start >> dirty_page_shift; page <= ( end - 1 ) >> dirty_page_shift; page++ )
+        dirty[page >> 6] |= 1ULL << ( page & 63 );
+}
+
+//------------------------------------------------------------------------------
+// Commits the pages of the reserved range up to 'bytes' ('reserve', 'hugepage' and 'file' storages only).
+// The range is committed by chunks of 'vm_commit_bytes' to limit the number of calls to mprotect(),
+// the committed pages that are never touched do not use any physical memory.
+// ('file' storage) The file is extended instead (its new blocks are holes, read as 0).
+// A page written when the disk is full raises SIGBUS (there is no error code with a mapped file), thus we first check
+// that the disk can hold the whole file, and throw an error otherwise.
+// ('hugepage' storage) Above 'hugepage_threshold', the committed range is marked for transparent huge pages:
+// the kernel then backs it with 2 MB pages when they are first touched (if it can, otherwise standard pages are used).
+void Bit_array::commit( const bigInt bytes ) {
+
+    if( bytes <= committed )
+        return;
+
+    const bigInt new_committed = ( ( bytes + vm_commit_bytes - 1 ) / vm_commit_bytes ) * vm_commit_bytes;
+    if( new_committed > vm_reserve_bytes )
+        throw std::runtime_error("Bit_array: the lattice is larger than the reserved virtual memory (see vm_reserve_bytes in Config_types.hpp)");
+
+    if( storage == Storage::file ) {
+        struct stat st;
+        struct statvfs vfs;
+        if( fstat( fd, &st ) == 0 && fstatvfs( fd, &vfs ) == 0
+                && (bigInt) vfs.f_bavail * vfs.f_frsize + (bigInt) st.st_blocks * 512 < new_committed )
+            throw std::runtime_error("Bit_array: not enough disk space for the lattice file in " + scratch_dir + " (see lattice_scratch_dir)");
+        if( ftruncate( fd, new_committed ) != 0 )
+            throw std::runtime_error("Bit_array: cannot grow the lattice file (see lattice_scratch_dir)");
+    } else if( mprotect( (char *) words + committed, new_committed - committed, PROT_READ | PROT_WRITE ) != 0 )
+        throw std::runtime_error("Bit_array: cannot commit the reserved virtual memory");
+
+    if( storage == Storage::hugepage && new_committed >= hugepage_threshold ) {
+        // (the whole range when the threshold is crossed, then only the new pages)
+        const bigInt from = committed >= hugepage_threshold ? committed : 0;
+        madvise( (char *) words + from, new_committed - from, MADV_HUGEPAGE ); // no huge pages: not an error
+    }
+
+    committed = new_committed;
+}
+
+//------------------------------------------------------------------------------
+// Grows the array to 'n' bits. The new bits are set to 0,
+// the previous bits are kept at the same position.
+void Bit_array::resize( const bigInt n ) {
+
+    if( n <= n_bits )
+        return;
+
+    const bigInt new_w = ( n + 63 ) >> 6;
+    if( new_w > n_w ) {
+        if( storage == Storage::heap ) {
+            uint64_t * p = (uint64_t *) realloc( words, ( new_w + 1 ) * sizeof(uint64_t) );
+            if( p == NULL )
+                throw std::runtime_error("Bit_array: cannot grow the lattice (out of memory)");
+            words = p;
+            memset( &words[n_w], 0, ( new_w - n_w ) * sizeof(uint64_t) );
+        } else
+            // the words above 'n_w' were never written, thus they are still 0:
+            commit( ( new_w + 1 ) * sizeof(uint64_t) );
+        n_w = new_w;
+        resize_dirty();
+    }
+    n_bits = n;
+}
+
+//------------------------------------------------------------------------------
+// Sets all the bits to 0.
+// Only the pages written since the last clear() are set to 0 (the other pages are still 0), such that
+// the cost is proportional to the area visited by the walker, not to the size of the lattice.
+// The memory is kept (no free, nor madvise), such that the array can be reused at no cost (see Lattice::reset()).
+// ('file' storage) The written pages are removed from the file instead (holes, read as 0), such that they are
+// neither kept in memory nor written to the disk.
+void Bit_array::clear() {
+
+    const bigInt page_words = 1ULL << ( dirty_page_shift - 6 );
+    for( bigInt d = 0; d < dirty.size(); d++ ) {
+        uint64_t w = dirty[d];
+        while( w != 0 ) {
+            const bigInt first = ( ( d << 6 ) + __builtin_ctzll( w ) ) * page_words;
+            const bigInt last = std::min( first + page_words, n_w + 1 ); //(+1: the extra word)
+            if( storage != Storage::file || fallocate( fd, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE,
+                    first * sizeof(uint64_t), ( last - first ) * sizeof(uint64_t) ) != 0 )
+                memset( &words[first], 0, ( last - first ) * sizeof(uint64_t) );
+            w &= w - 1; //clear the lowest bit set
+        }
+        dirty[d] = 0;
+    }
+}
+
+//------------------------------------------------------------------------------
+// Returns the number of bits set to 1.
+// Bits above 'n_bits' are never set, so whole words can be counted:
+bigInt Bit_array::count() const {
+    bigInt c = 0;
+    for( bigInt i = 0; i < n_w; i++ )
+        c += __builtin_popcountll( words[i] );
+    return c;
+}
+
+//------------------------------------------------------------------------------
+// Writes the positions of all the bits equal to 'value' into 'pos' (in increasing order)
+// and returns the number of positions written.
+// 'pos' should hold count() (value = 1) or size() - count() (value = 0) elements.
+// Each word is scanned at once, then its bits are extracted with a 'count trailing zeros'.
+bigInt Bit_array::gather( bigInt * pos, const bool value ) const {
+
+    bigInt n = 0;
+    for( bigInt i = 0; i < n_w; i++ ) {
+        uint64_t w = value ? words[i] : ~words[i];
+
+        // discard the bits above 'n_bits' (last word only):
+        if( i == n_w - 1 && ( n_bits & 63 ) != 0 )
+            w &= ( 1ULL << ( n_bits & 63 ) ) - 1;
+
+        while( w != 0 ) {
+            pos[n++] = ( i << 6 ) + __builtin_ctzll( w );
+            w &= w - 1; //clear the lowest bit set
+        }
+    }
+    return n;
+}
+
+//------------------------------------------------------------------------------
+// Moves the 'n' bits starting at position 'src' to position 'dst' (as memmove() does for bytes).
+// The bits are copied by chunks of 64, from the end of the range if dst > src (such that the
+// source is read before it is overwritten), from the start otherwise.
+// The bits of the source range that are not covered by the destination are left unchanged.
+void Bit_array::move( const bigInt dst, const bigInt src, const bigInt n ) {
+
+    if( dst == src || n == 0 )
+        return;
+
+    mark_dirty( dst, dst + n );
+
+    if( dst > src ) {
+        bigInt i = n;
+        while( i > 0 ) {
+            const unsigned len = i < 64 ? (unsigned) i : 64;
+            i -= len;
+            put_bits( dst + i, len, get_bits( src + i, len ) );
+        }
+    } else
+        for( bigInt i = 0; i < n; ) {
+            const unsigned len = n - i < 64 ? (unsigned) ( n - i ) : 64;
+            put_bits( dst + i, len, get_bits( src + i, len ) );
+            i += len;
+        }
+}
+
+//------------------------------------------------------------------------------
+// Sets the bits in [start, end) to 'value'.
+// The words fully inside the range are written at once (memset).
+void Bit_array::fill( const bigInt start, const bigInt end, const bool value ) {
+
+    if( start >= end )
+        return;
+
+    if( value )
+        mark_dirty( start, end );
+
+    const uint64_t w = value ? ~0ULL : 0ULL;
+    bigInt i = start;
+
+    // head (up to the first word boundary):
+    if( ( i & 63 ) != 0 ) {
+        const unsigned len = std::min( end - i, (bigInt) ( 64 - ( i & 63 ) ) );
+        put_bits( i, len, w );
+        i += len;
+    }
+    // whole words:
+    const bigInt n_full = ( end - i ) >> 6;
+    memset( &words[i >> 6], value ? 0xFF : 0x00, n_full * sizeof(uint64_t) );
+    i += n_full << 6;
+    // tail:
+    if( i < end )
+        put_bits( i, (unsigned) ( end - i ), w );
+}
+
+//------------------------------------------------------------------------------
+// Returns true if at least one bit in [start, end) is set to 1.
+bool Bit_array::any( const bigInt start, const bigInt end ) const {
+
+    bigInt i = start;
+    while( i < end ) {
+        const unsigned len = end - i < 64 ? (unsigned) ( end - i ) : 64;
+        if( get_bits( i, len ) != 0 )
+            return true;
+        i += len;
+    }
+    return false;
+}
+
+//------------------------------------------------------------------------------
+// Getters:
+bigInt Bit_array::size() const {
+    return n_bits;
+}
+
+bigInt Bit_array::n_words() const {
+    return n_w;
+}
+
+uint64_t * Bit_array::data() {
+    return words;
+}
+
+const uint64_t * Bit_array::data() const {
+    return words;
+}
+
+bigInt Bit_array::memory_bytes() const {
+    return n_w * sizeof(uint64_t);
+}
+
+//------------------------------------------------------------------------------
+// Returns the number of bytes of the array actually backed by huge pages,
+// i.e. the sum of the 'AnonHugePages' fields of /proc/self/smaps for the mappings of the array.
+// (this is always 0 for the 'heap' and 'reserve' storages, unless transparent huge pages are set to 'always')
+bigInt Bit_array::huge_page_bytes() const {
+
+    std::ifstream smaps( "/proc/self/smaps" );
+    if( !smaps )
+        return 0;
+
+    const uintptr_t lo = (uintptr_t) words;
+    const uintptr_t hi = lo + std::max( memory_bytes(), (bigInt) 1 );
+    bool inside = false;
+    bigInt bytes = 0;
+    std::string line;
+    while( std::getline( smaps, line ) ) {
+        unsigned long start = 0, end = 0, kb = 0;
+        if( sscanf( line.c_str(), "%lx-%lx", &start, &end ) == 2 )
+            inside = start < hi && end > lo; // header of a mapping: does it overlap the array?
+        else if( inside && sscanf( line.c_str(), "AnonHugePages: %lu kB", &kb ) == 1 )
+            bytes += (bigInt) kb * 1024;
+    }
+    return bytes;
+}
+
+//------------------------------------------------------------------------------
+// Destructor
+Bit_array::~Bit_array() {
+    if( storage == Storage::heap )
+        free( words );
+    else
+        munmap( map_base, map_bytes );
+    if( fd >= 0 )
+        close( fd ); //('file' storage) the file is removed
+}
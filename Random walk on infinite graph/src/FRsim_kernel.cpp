@@ -0,0 +1,46 @@
+/*==========================================================
+ * RANDOM WALK simulation for Functionnal responses
+ * version 1.0 with 2D and nD (infinite) lattices
+  *========================================================*/
+#include "FRsim_kernel.hpp"
+
+/*==========================================================
+ * FRsim_kernel (simulation), see 'FRsim_kernel.hpp' for the policies and the walk
+ *
+ *========================================================*/
+//------------------------------------------------------------------------------
+// Creates the simulation for the perturbations 'perturb' (flags, see Config_types.hpp), in the dimension of the lattice.
+// The walks with drift and jumps can not be combined (both are a type of step), see main_FRsim.cpp.
+// 'seed' is the seed of the lazy percolation (0: the lattice is percolated at start), see Landscape_lazy.
+FRsim_base * make_FRsim( const unsigned perturb, const bigInt cur_n, const double end_time,
+        const std::shared_ptr<Lattice> lattice,
+        const std::shared_ptr<Walker> walker,
+        const double p_drift, const std::shared_ptr<Power_law> PL, const uint64_t seed ) {
+
+    // the default lattices of the dimension, and the standard lattice, are called directly (see FRsim_kernel.hpp),
+    // the others through Lattice:
+    switch( lattice->get_L_dim() ) {
+        case 1 :
+            if( dynamic_cast<Lattice_range *>( lattice.get() ) != NULL )
+                return make_step<1, Lattice_range>( perturb, cur_n, end_time, lattice, walker, p_drift, PL, seed );
+            if( dynamic_cast<Lattice_baseconversion *>( lattice.get() ) != NULL )
+                return make_step<1, Lattice_baseconversion>( perturb, cur_n, end_time, lattice, walker, p_drift, PL, seed );
+            return make_step<1, Lattice>( perturb, cur_n, end_time, lattice, walker, p_drift, PL, seed );
+        case 2 :
+            if( dynamic_cast<Lattice_spiral *>( lattice.get() ) != NULL )
+                return make_step<2, Lattice_spiral>( perturb, cur_n, end_time, lattice, walker, p_drift, PL, seed );
+            if( dynamic_cast<Lattice_window *>( lattice.get() ) != NULL )
+                return make_step<2, Lattice_window>( perturb, cur_n, end_time, lattice, walker, p_drift, PL, seed );
+            if( dynamic_cast<Lattice_baseconversion *>( lattice.get() ) != NULL )
+                return make_step<2, Lattice_baseconversion>( perturb, cur_n, end_time, lattice, walker, p_drift, PL, seed );
+            return make_step<2, Lattice>( perturb, cur_n, end_time, lattice, walker, p_drift, PL, seed );
+        default:
+            if( dynamic_cast<Lattice_sparse *>( lattice.get() ) != NULL )
+                return make_step<3, Lattice_sparse>( perturb, cur_n, end_time, lattice, walker, p_drift, PL, seed );
+            if( dynamic_cast<Lattice_window *>( lattice.get() ) != NULL )
+                return make_step<3, Lattice_window>( perturb, cur_n, end_time, lattice, walker, p_drift, PL, seed );
+            if( dynamic_cast<Lattice_baseconversion *>( lattice.get() ) != NULL )
+                return make_step<3, Lattice_baseconversion>( perturb, cur_n, end_time, lattice, walker, p_drift, PL, seed );
+            return make_step<3, Lattice>( perturb, cur_n, end_time, lattice, walker, p_drift, PL, seed );
+    }
+}
@@ -0,0 +1,18 @@
+/*==========================================================
+ * RANDOM WALK simulation for Functionnal responses
+ * version 1.0 with 2D and nD (infinite) lattices
+  *========================================================*/
+#include "FRsim_kernel.hpp"
+
+// The walks in a lattice of dimension 1 (every combination of the perturbations), see make_FRsim():
+// on the default lattice of the dimension (Lattice_range), on the standard lattice (Lattice_baseconversion),
+// and on any lattice (virtual calls)
+template FRsim_base * make_step<1, Lattice_range>( const unsigned, const bigInt, const double,
+        const std::shared_ptr<Lattice>, const std::shared_ptr<Walker>,
+        const double, const std::shared_ptr<Power_law>, const uint64_t );
+template FRsim_base * make_step<1, Lattice_baseconversion>( const unsigned, const bigInt, const double,
+        const std::shared_ptr<Lattice>, const std::shared_ptr<Walker>,
+        const double, const std::shared_ptr<Power_law>, const uint64_t );
+template FRsim_base * make_step<1, Lattice>( const unsigned, const bigInt, const double,
+        const std::shared_ptr<Lattice>, const std::shared_ptr<Walker>,
+        const double, const std::shared_ptr<Power_law>, const uint64_t );
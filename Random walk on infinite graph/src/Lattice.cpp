@@ -13,8 +13,10 @@
 // Constructor
 // L_dim_space is the number of nodes on one side (one dimension) of the lattice
 // L_space is 'delta'
+// storage defines where the visited nodes are stored (see Bit_array.hpp)
+// growth is the factor applied to L_dim_size when the lattice is resized (see get_n_layers())
 // warning: no type-cast verification here.
-Lattice::Lattice(const bigInt n_preys, const bigInt N0, const double lattice_size, const unsigned dim, const double percolation_value, const unsigned x_max)
+Lattice::Lattice(const bigInt n_preys, const bigInt N0, const double lattice_size, const unsigned dim, const double percolation_value, const unsigned x_max, const Bit_array::Storage storage, const double growth)
     :nodes{N0}, L_size{lattice_size}, L_dim{dim},
     //Let's use a ternary operator for dim 1, as we don't need the std::pow() machinery for this dimension:
     L_dim_size{ 
@@ -25,12 +27,11 @@ Lattice::Lattice(const bigInt n_preys, const bigInt N0, const double lattice_siz
         dim == 1 ? lattice_size / ( n_preys - 1 ) 
         : lattice_size / ( std::pow( n_preys, 1.0/dim ) - 1 ) 
     },
+    is_visited{ N0, storage },   //all elements (bits) initialized to 0
     p_perco{ percolation_value },
-    max_jump_size{ x_max }
-{
-    is_visited = (char *) malloc(N0 * sizeof(char));
-    memset(is_visited, '\0', N0 * sizeof(char) );  //all elements initialized to '\0'
-}
+    max_jump_size{ x_max },
+    growth_factor{ growth }
+{}
     
 //------------------------------------------------------------------------------
 // Print information (for information purposes)
@@ -43,39 +44,149 @@ void Lattice::print_info() const {
     std::cout << "L_space = " << L_space << " (spacing between nodes)" << std::endl;
 }
 
+//------------------------------------------------------------------------------
+// Returns the number of layers (nodes on each side of the lattice, in each dimension)
+// to add when the walker is outside the lattice:
+// the lattice side L_dim_size grows geometrically (L_dim_size * growth_factor), such that the
+// number of resizes of a simulation grows as log(range of the walk) and the cost of the resizes
+// (proportional to the number of nodes moved) is amortized.
+// 'n_min' is the minimal number of layers required to hold the walker (e.g. max_jump_size for jumps).
+unsigned Lattice::get_n_layers( const unsigned n_min ) const {
+    const unsigned n_geo = (unsigned) std::ceil( ( growth_factor - 1.0 ) * L_dim_size / 2.0 );
+    return std::max( n_min, n_geo );
+}
+
 //------------------------------------------------------------------------------
 // Percolate the lattice according to 'p_perco' (between [0, 1])
 // This function percolates the initial lattice (ie. at the start of the simulation)
 // Another function is provided (see below) for the percolation of new, added sites 
 // (when the walker is outside the current lattice)
 void Lattice::percolate_init( std::mt19937_64 &engine ) {
+    // The whole lattice is percolated at start (see percolate_new()):
+    // a node is set to 1 (consider it has already been visited, =empty) with probability p_perco.
+    percolate_new( 0, nodes, engine );
+}
 
-    std::uniform_real_distribution<double> rand_p(0.0, 1.0);
-
-    // This loop can be time consuming at start, 
-    // depending on the value of N0_1D, N0_2D or N0_3D (see 'include/Config_types.hpp').
-    // Recall that all values of is_visited[] were previously set to '0' using memset(),
-    // such that we don't need to push '0' values (i.e. else is_visited[p++] = '\0';).
-    // Note that this loop can be costly in terms of running-time, depending on 'N0' values
-    // (see 'Config_types.hpp')
-    for( bigInt p=0; p < nodes; p++ ) {
-        if( rand_p(engine) < p_perco )
-            is_visited[p] = '1'; //set to '1', consider it has already been visited (=empty)
-    }
+// number of threads percolating the chunks of a large range (1: the chunks are percolated by the calling thread):
+unsigned Lattice::percolate_threads = 1;
+
+//------------------------------------------------------------------------------
+// Sets the number of threads percolating the chunks of a large range (see percolate_new()).
+// The lattices are percolated inside the parallel region of the simulations (see main_FRsim.cpp), thus this is
+// the share of the cores left to each simulation (nested parallelism), and 1 if every core runs a simulation.
+void Lattice::set_percolate_threads( const unsigned n_threads ) {
+    percolate_threads = std::max( 1u, n_threads );
 }
 
 //------------------------------------------------------------------------------
-// Percolates new (added) nodes to the original lattice.
+// Percolates new (added) nodes [index_start, index_end) to the original lattice.
+// A large range (e.g. the initial lattice) is cut into chunks of percolate_chunk_words words (see 'Config_types.hpp'),
+// percolated in parallel by 'percolate_threads' threads: each chunk has its own engine, seeded from 'engine', such that the result
+// does not depend on the number of threads. The chunks start on a word, thus no word is shared by two threads.
 void Lattice::percolate_new( const bigInt index_start, const bigInt index_end, std::mt19937_64 &engine ) {
-    
-    std::uniform_real_distribution<double> rand_p(0.0, 1.0);
 
-    bigInt p = index_start;
-    while( p < index_end )
-        if( rand_p(engine) < p_perco )
-            is_visited[p++] = '1'; //already visited (=empty)
+    if( index_end <= index_start )
+        return;
+
+    // the nodes are set to 0, then the empty nodes are set directly in the words (see percolate_range()):
+    // their pages are marked as written, such that Bit_array::clear() resets them if the lattice is reused.
+    is_visited.fill( index_start, index_end, false );
+    is_visited.mark_dirty( index_start, index_end );
+
+    const bigInt n_chunks = ( index_end - index_start ) / ( percolate_chunk_words << 6 );
+    if( n_chunks < 2 ) {
+        percolate_range( index_start, index_end, engine );
+        return;
+    }
+
+    std::vector<uint64_t> seeds( n_chunks );
+    for( uint64_t & s : seeds )
+        s = engine();
+
+    const bigInt w0 = index_start >> 6;
+#pragma omp parallel for schedule(dynamic) num_threads( percolate_threads ) if( percolate_threads > 1 )
+    for( long long int k = 0; k < (long long int) n_chunks; k++ ) {
+        std::mt19937_64 chunk_engine( seeds[k] );
+        const bigInt start = k == 0 ? index_start : ( w0 + k * percolate_chunk_words ) << 6;
+        const bigInt end = k + 1 == (long long int) n_chunks ? index_end : ( w0 + ( k + 1 ) * percolate_chunk_words ) << 6;
+        percolate_range( start, end, chunk_engine );
+    }
+}
+
+//------------------------------------------------------------------------------
+// Percolates the nodes [start, end), whose bits are 0:
+// - if p_perco < percolate_skip_p (see 'Config_types.hpp'), only the empty nodes are drawn, by drawing the
+//   gaps between two empty nodes (geometric distribution),
+// - if p_perco > 1 - percolate_skip_p, all the nodes are set to 1, and the nodes with a prey (0) are drawn the same way,
+// - otherwise, the nodes are drawn by words of 64 nodes (see percolate_word()).
+void Lattice::percolate_range( const bigInt start, const bigInt end, std::mt19937_64 &engine ) {
+
+    if( p_perco <= 0.0 || end <= start )
+        return;
+
+    uint64_t * words = is_visited.data();
+    const bool sparse = p_perco < percolate_skip_p;
+    const bool dense = p_perco > 1.0 - percolate_skip_p;
+
+    if( sparse == false ) {
+        const bigInt w_first = start >> 6, w_last = ( end - 1 ) >> 6;
+        for( bigInt w = w_first; w <= w_last; w++ ) {
+            uint64_t m = ~0ULL;
+            if( w == w_first )
+                m &= ~0ULL << ( start & 63 );
+            if( w == w_last )
+                m &= ~0ULL >> ( 63 - ( ( end - 1 ) & 63 ) );
+            words[w] |= ( dense ? ~0ULL : percolate_word( engine ) ) & m;
+        }
+    }
+
+    if( ( sparse || dense ) && p_perco < 1.0 ) {
+        // a gap is the number of nodes before the next empty node (sparse), or the next node with a prey (dense):
+        std::geometric_distribution<bigInt> gap( sparse ? p_perco : 1.0 - p_perco );
+        for( bigInt p = start + gap( engine ); p < end; p += 1 + gap( engine ) )
+            words[p >> 6] ^= 1ULL << ( p & 63 );
+    }
+}
+
+//------------------------------------------------------------------------------
+// Returns 64 nodes percolated at once (bit j = 1: the node j is empty, with probability p_perco).
+// The node j is empty if U_j < p_perco, where U_j is uniform in [0, 1): the bits of the 64 U_j are drawn
+// one word at a time, from the most significant one, and compared to the bits of p_perco.
+// A node is decided at its first bit that differs from p_perco, thus about half of the undecided nodes are decided
+// by each word drawn: 64 nodes cost about 8 words (1 word if p_perco = 0.5), instead of 64 draws.
+uint64_t Lattice::percolate_word( std::mt19937_64 &engine ) const {
+
+    if( p_perco >= 1.0 )
+        return ~0ULL;
+
+    uint64_t empty = 0, undecided = ~0ULL;
+    double p = p_perco;
+    for( unsigned k = 0; k < 53 && undecided != 0 && p > 0.0; k++ ) {
+        p *= 2.0;
+        const uint64_t r = engine();
+        if( p >= 1.0 ) {
+            // the bit of p_perco is 1: the nodes whose bit is 0 are empty (U_j < p_perco)
+            p -= 1.0;
+            empty |= undecided & ~r;
+            undecided &= r;
+        }
         else
-            is_visited[p++] = '\0'; //not visited
+            // the bit of p_perco is 0: the nodes whose bit is 1 have a prey (U_j > p_perco)
+            undecided &= ~r;
+    }
+    // (the nodes still undecided have U_j >= p_perco, they have a prey)
+    return empty;
+}
+
+//------------------------------------------------------------------------------
+// Lazy percolation: returns true if the node 'pt' is empty (probability p_perco) in the landscape 'seed'.
+// The node is empty if the hash of the seed and of its coordinates, as a uniform number in [0, 1) (53 bits),
+// is below p_perco: the nodes are independent, and a node is always empty (or not) in the same landscape.
+bool Lattice::is_empty( const PointND & pt, const uint64_t seed ) const {
+    uint64_t h = hash( seed );
+    for( unsigned i = 0; i < L_dim; i++ )
+        h = hash( h ^ (uint64_t) pt[i] );
+    return (double) ( h >> 11 ) / 9007199254740992.0 < p_perco;
 }
 
 //------------------------------------------------------------------------------
@@ -84,6 +195,34 @@ double Lattice::get_L_space() const {
     return L_space;
 }
 
+//------------------------------------------------------------------------------
+// Return L_dim_size (number of nodes on one side of the lattice)
+bigInt Lattice::get_L_dim_size() const {
+    return L_dim_size;
+}
+
+//------------------------------------------------------------------------------
+// Reset the lattice for a new simulation: all the nodes are marked as not visited.
+// The lattice keeps its (grown) size and its memory, and only the pages visited by the previous walker are cleared
+// (see Bit_array::clear()), such that a lattice can be reused by many simulations at (almost) no cost.
+// Thus, the derived lattices must write the nodes through Bit_array (set(), move(), fill()), or mark the pages they write through data() (mark_dirty()),
+// otherwise a reused lattice keeps the nodes visited by the previous walker.
+void Lattice::reset() {
+    is_visited.clear();
+}
+
+//------------------------------------------------------------------------------
+// Return the size of the visited nodes (bytes)
+bigInt Lattice::get_memory_bytes() const {
+    return is_visited.memory_bytes();
+}
+
+//------------------------------------------------------------------------------
+// Return the number of bytes of the visited nodes actually backed by huge pages (see Bit_array::huge_page_bytes())
+bigInt Lattice::get_huge_page_bytes() const {
+    return is_visited.huge_page_bytes();
+}
+
 //------------------------------------------------------------------------------
 // Return L_dim (spacing between nodes)
 unsigned Lattice::get_L_dim() const {
@@ -109,7 +248,5 @@ void Lattice::set_center_pos( PointND & center_pos ) const {
 }
 
 //------------------------------------------------------------------------------
-// Destructor
-Lattice::~Lattice() {
-    free(is_visited);
-}
+// Destructor ('is_visited' releases its own memory)
+Lattice::~Lattice() {}
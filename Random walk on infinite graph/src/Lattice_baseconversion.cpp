@@ -11,8 +11,8 @@
  *========================================================*/
 //------------------------------------------------------------------------------
 // Constructor:
-Lattice_baseconversion::Lattice_baseconversion(const bigInt n_preys, const bigInt N0, const double lattice_size, const unsigned dim, const double percol_value, const unsigned x_max)
-:Lattice(n_preys, N0, lattice_size, dim, percol_value, x_max) {
+Lattice_baseconversion::Lattice_baseconversion(const bigInt n_preys, const bigInt N0, const double lattice_size, const unsigned dim, const double percol_value, const unsigned x_max, const Bit_array::Storage storage, const double growth)
+:Lattice(n_preys, N0, lattice_size, dim, percol_value, x_max, storage, growth) {
     
     // Warning: N0 should be 'odd', otherwise it will create an offset error.
     // In particular in the get_n_nodes_after_jump() function.
@@ -54,7 +54,7 @@ bigInt Lattice_baseconversion::get_n_nodes( const unsigned n_layers ) const {
 // The walker is outside the lattice, thus we resize the lattice.
 // 'to add' is the number of nodes to add to the lattice.
 // This version implements a vector approach.
-void Lattice_baseconversion::resize_lattice_vector( const unsigned to_add, const unsigned n_layers ) {
+void Lattice_baseconversion::resize_lattice_vector( const bigInt to_add, const unsigned n_layers ) {
     
     // ----------------------- MEMORY REALLOCATION ('visited' array):
     // In the following section we assume that the sum of visited positions holds in a 'bigInt' type.
@@ -71,19 +71,16 @@ void Lattice_baseconversion::resize_lattice_vector( const unsigned to_add, const
     
     // (A) Declare the array (vector) of visited positions and
     // fill it with the index of positions already visited:
-    std::vector<bigInt> index_visited;
-    for(bigInt i=0; i < nodes; ++i) {
-        if(is_visited[i] == '1')
-            index_visited.push_back(i);
-    }
+    std::vector<bigInt> index_visited( is_visited.count() );
+    is_visited.gather( index_visited.data(), true );
     
     // (B) We reset 'visited' array and reallocate the memory accordingly to new number of nodes:
     // (B-1) the total number of nodes in the lattice is now:
     nodes += to_add;
     
     // (B-2) the size of the array (re-allocation):
-    is_visited  = (char *) realloc( is_visited, nodes * sizeof(char) );
-    memset( &is_visited[0], '\0', nodes * sizeof(char) ); //we reset all the values to '\0'
+    is_visited.resize( nodes );
+    is_visited.clear(); //we reset all the values to 0
     
     // We update 'L_DIM_SIZE' and 'k' variables:
     L_dim_size += 2 * n_layers;
@@ -109,7 +106,7 @@ void Lattice_baseconversion::resize_lattice_vector( const unsigned to_add, const
         idx2 = get_index( *pt );
         
         // this site is marked as (already) visited:
-        is_visited[idx2] = '1';
+        is_visited.set( idx2 );
     }
     
     delete pt;
@@ -118,65 +115,79 @@ void Lattice_baseconversion::resize_lattice_vector( const unsigned to_add, const
 //------------------------------------------------------------------------------
 // The walker is outside the lattice, thus we resize the lattice.
 // 'to add' is the number of nodes to add to the lattice.
-// This version implements a C array.
-void Lattice_baseconversion::resize_lattice_carray( const unsigned to_add, const unsigned n_layers ) {
-
-    // ----------------------- MEMORY REALLOCATION ('visited' array):
-    // (A) Declare the array (vector) of visited positions and
-    // fill it with the index of positions already visited:
-    bigInt * index_visited = (bigInt *) malloc(nodes * sizeof(bigInt));
-    // we fill it with the index of visited positions:
-    bigInt n_visited = 0;
-    for(bigInt i=0; i < nodes; ++i) {
-        if(is_visited[i] == '1')
-            index_visited[n_visited++] = i;
-    }
-    
-    // (B) We reset 'visited' array and reallocate the memory accordingly to new number of nodes:
-    // (B-1) the total number of nodes in the lattice:
-    //const bigInt old_nodes = nodes; // save old values of 'nodes' before increasing 'nodes'
-    nodes += to_add; // new N_0
+// This version moves the visited nodes in place (no index array):
+// in the base conversion index, a 'row' of the lattice (the L_dim_size nodes along the first dimension,
+// for given y, z coordinates) is stored contiguously, and each row keeps its content after the resize:
+// it is only shifted to a new offset. Since the new offset of a row is always larger than its old offset,
+// the rows can be moved back to front (the last row first) inside the same array, without overwriting
+// the rows not moved yet.
+// The gaps left between the moved rows are the new nodes: they are set to 0 (not visited),
+// or percolated if 'engine' is not NULL.
+// Thus, the memory used is the new array only, and the time scales with the old number of nodes.
+void Lattice_baseconversion::resize_lattice_inplace( const bigInt to_add, const unsigned n_layers, std::mt19937_64 * engine ) {
+
+    const bigInt old_size = L_dim_size;        //old number of nodes on one side
+    const bigInt new_size = L_dim_size + 2 * n_layers;  //new number of nodes on one side
+
+    // (A) we reallocate the memory accordingly to new number of nodes
+    // (the old nodes are kept at the start of the array):
+    nodes += to_add;
+    is_visited.resize( nodes );
+
+    // (B) we move the rows (y, z), from the last one to the first one.
+    // The rows are shifted by 'n_layers' in each dimension (there is only one row in 1D, and z = 0 in 2D).
+    // 'next_start' is the start of the previous row moved (i.e. the end of the current gap):
+    const bigInt n_y = L_dim > 1 ? old_size : 1, shift_y = L_dim > 1 ? n_layers : 0;
+    const bigInt n_z = L_dim > 2 ? old_size : 1, shift_z = L_dim > 2 ? n_layers : 0;
+    bigInt src = nodes - to_add;
+    bigInt next_start = nodes;
+    for( bigInt z = n_z; z-- > 0; )
+        for( bigInt y = n_y; y-- > 0; ) {
+            src -= old_size;
+            const bigInt dst = ( y + shift_y + new_size * ( z + shift_z ) ) * new_size + n_layers;
+
+            // without percolation, an empty row (no visited node) is not moved:
+            // it is merged into the gap, which is filled with 0 at once with the next row moved.
+            if( engine == NULL && is_visited.any( src, src + old_size ) == false )
+                continue;
+
+            is_visited.move( dst, src, old_size );
+            new_nodes( dst + old_size, next_start, engine );
+            next_start = dst;
+        }
+    new_nodes( 0, next_start, engine );
 
-    // (B-2) the size of the array (re-allocation):
-    is_visited  = (char *) realloc( is_visited, nodes * sizeof(char) );
-    memset( &is_visited[0], '\0', nodes * sizeof(char) ); //we reset all the values to '\0'
+    // (C) We update 'L_DIM_SIZE' and 'k' variables:
+    L_dim_size = new_size;
+    k = (cInt) (L_dim_size-1) / 2;
+}
 
-    // We update 'L_DIM_SIZE' and 'k' variables:
-    L_dim_size += 2 * n_layers;
-    const cInt new_k = (cInt) (L_dim_size-1) / 2; //new value of 'k'
-    const cInt old_k = k; //old value of 'k'
-    //we switch between the two 'k' in order to change the bases (see next section).
+//------------------------------------------------------------------------------
+// The walker is outside the lattice: the lattice grows geometrically, and at least by 'min_layers' layers
+// (see Lattice::get_n_layers()). The new nodes are percolated if 'engine' is not NULL.
+// (used by the cursor, see Lattice_baseconversion::Cursor)
+void Lattice_baseconversion::grow( const unsigned min_layers, std::mt19937_64 * engine ) {
+    const unsigned n_layers = get_n_layers( min_layers );
+    resize_lattice_inplace( get_n_nodes( n_layers ), n_layers, engine );
+}
 
-    // ----------------------- RE-FILL THE ARRAY WITH PREVIOUS VALUES:
-    //std::cout << "STEP 3\n";
-    // We now update the new 'is_visited':
-    PointND * pt = new PointND( L_dim );
-    bigInt idx2 = 0;
-    for(bigInt kn = 0; kn < n_visited; kn++) {
-        // get index 'n' at position index_visited[i] and
-        // compute it back to PointND:
-        k = old_k;
-        get_Point_from_index( index_visited[kn], *pt );     //get corresponding position
-        
-        // compute the new index with new 'k':
-        k = new_k;
-        idx2 = get_index( *pt );
-        
-        // this site is marked as (already) visited:
-        is_visited[idx2] = '1';
-    }
-    
-    free(index_visited);
-    delete pt;
+//------------------------------------------------------------------------------
+// Initializes the new nodes in [start, end) (added when resizing the lattice):
+// they are either not visited (0), or percolated if 'engine' is not NULL.
+void Lattice_baseconversion::new_nodes( const bigInt start, const bigInt end, std::mt19937_64 * engine ) {
+    if( engine == NULL )
+        is_visited.fill( start, end, false );
+    else
+        percolate_new( start, end, *engine );
 }
 
 //------------------------------------------------------------------------------
 // Check if node is already visited, if not, mark it as visited.
-// We also check the node is inside the lattice, otherwise we increase its size by 'n_layers' layers (hardcoded value).
+// We also check the node is inside the lattice, otherwise we increase its size by 'n_layers' layers (see Lattice::get_n_layers()).
 bool Lattice_baseconversion::check_new_node(const PointND * pt) {
 
     bigInt idx = 0;
-    const unsigned n_layers = 100;   // hardcoded parameter, where one 'layer' is the number of nodes required for k = k+1 (i.e. increasing size of lattice by 1)
+    unsigned n_layers = 0;           // where one 'layer' is the number of nodes required for k = k+1 (i.e. increasing size of lattice by 1)
     bigInt to_add = 0;               // number of new nodes (or indexes in the array) to add, initialized at 0.
 
     // we first gather the index of the position 'pt' in the 'visited' array:
@@ -187,11 +198,12 @@ bool Lattice_baseconversion::check_new_node(const PointND * pt) {
     // possible positions in the lattice with current size L.
     // Otherwise, we increase the size of the lattice:
     if( idx >= nodes ) {
-        // compute the number of nodes to add to the lattice
+        // compute the number of layers and nodes to add to the lattice (geometric growth of L_dim_size):
+        n_layers = get_n_layers( 1 );
         to_add = get_n_nodes( n_layers );
         
         // resize the lattice accordingly:
-        resize_lattice_carray( to_add, n_layers ); //for c-style array implementation
+        resize_lattice_inplace( to_add, n_layers, NULL ); //in-place implementation
         //resize_lattice_vector( to_add, n_layers ); // alternative vector() implementation
 
         // we changed the base and 'k', the current index 'idx' is not longer valid.
@@ -200,21 +212,18 @@ bool Lattice_baseconversion::check_new_node(const PointND * pt) {
     }
     
     // check whether the site is already visited or not:
-    if(is_visited[idx] == '\0') {
-        is_visited[idx] = '1';
-        return true;
-    }
-    return false;
+    // (test_and_set() marks the node as visited and returns its previous state):
+    return is_visited.test_and_set( idx ) == false;
 }
 
 //------------------------------------------------------------------------------
 // Check if node is already visited, if not, mark it as visited.
-// We also check the node is inside the lattice, otherwise we increase its size by 'n_layers' layers (hardcoded value).
+// We also check the node is inside the lattice, otherwise we increase its size by 'n_layers' layers (see Lattice::get_n_layers()).
 // (Percolation version)
 bool Lattice_baseconversion::check_new_node(const PointND * pt, std::mt19937_64 & engine) {
     
     bigInt idx = 0;
-    const unsigned n_layers = 100;   // hardcoded parameter, where one 'layer' is the number of nodes required for k = k+1 (i.e. increasing size of lattice by 1)
+    unsigned n_layers = 0;           // where one 'layer' is the number of nodes required for k = k+1 (i.e. increasing size of lattice by 1)
     bigInt to_add = 0;               // number of new nodes (or indexes in the array) to add.
 
     // we first gather the index of the position 'pt' in the 'visited' array:
@@ -226,136 +235,34 @@ bool Lattice_baseconversion::check_new_node(const PointND * pt, std::mt19937_64
     // Otherwise, we increase the size of the lattice:
     if( idx >= nodes ) {
         
-        // compute the number of nodes to add to the lattice
+        // compute the number of layers and nodes to add to the lattice (geometric growth of L_dim_size):
+        n_layers = get_n_layers( 1 );
         to_add = get_n_nodes( n_layers );
         
-        // ----------------------- MEMORY REALLOCATION ('visited' array):
-        // Here we use a different method:
-        // (1) we find the visited ('1') and non-visited ('0') sites/nodes,
-        // (2) we compute the new indexes of visited and non-visited sites,
-        // (3) all other indexes are considered as new sites/nodes (with '0' value),
-        // (4) we then percolate these new sites/nodes.
-        
-        // (A) Declare the array (vector) of visited positions and
-        // fill it with the index of positions already visited:
-        bigInt * index_visited = (bigInt *) malloc(nodes * sizeof(bigInt));
-        bigInt * index_not_visited = (bigInt *) malloc(nodes * sizeof(bigInt));
-        // we fill it with the index of visited and not visited positions:
-        bigInt n_visited = 0; // is the number of visited sites.
-        bigInt not_visited = 0;
-        for(bigInt i=0; i < nodes; ++i) {
-            if(is_visited[i] == '1')
-                index_visited[n_visited++] = i;
-            else
-                index_not_visited[not_visited++] = i;
-        }
-        
-        // (B) We reset 'visited' array and reallocate the memory accordingly to new number of nodes:
-        // (B-1) the total number of nodes in the lattice is:
-        nodes += to_add;
-        
-        // (B-2) the size of the array (re-allocation):
-        is_visited  = (char *) realloc( is_visited, nodes * sizeof(char) );
-        memset( &is_visited[0], '\0', nodes * sizeof(char) ); //we reset all the values to '\0'
+        // resize the lattice accordingly, the visited and not visited nodes keep their state,
+        // and only the new nodes are percolated:
+        resize_lattice_inplace( to_add, n_layers, &engine );
         
-        // We update 'L_DIM_SIZE' and 'k' variables:
-        L_dim_size += 2 * n_layers;
-        
-        const cInt new_k = (cInt) (L_dim_size-1) / 2; //new value of 'k'
-        const cInt old_k = k; //old value of 'k'
-        //we switch between the two 'k' in order to change the bases (see next section).
-        
-        // ----------------------- RE-FILL THE ARRAY WITH PREVIOUS (VISITED) VALUES:
-        // We now update the new 'is_visited':
-        PointND * pt = new PointND( L_dim );
-        bigInt idx2 = 0;
-        for(bigInt kn = 0; kn < n_visited; kn++) {
-            
-            // get index 'n' at position index_visited[i] and
-            // compute it back to PointND:
-            k = old_k;
-            get_Point_from_index( index_visited[kn], *pt );     //get corresponding position
-            
-            // compute the new index with new 'k':
-            k = new_k;
-            idx2 = get_index( *pt );
-            
-            // this site is marked as (already) visited:
-            is_visited[idx2] = '1';
-        }
-        
-        // ----------------------- RE-FILL THE ARRAY WITH PREVIOUS (NOT VISITED) VALUES:
-        // We now update the new 'is_visited':
-        for(bigInt kn = 0; kn < not_visited; kn++) {
-            
-            // get index 'n' at position index_visited[i] and
-            // compute it back to PointND:
-            k = old_k;
-            get_Point_from_index( index_not_visited[kn], *pt );     //get corresponding position
-            
-            // compute the new index with new 'k':
-            k = new_k;
-            idx2 = get_index( *pt );
-            
-            // this site is marked with a special value '2':
-            is_visited[idx2] = '2';
-        }
-        
-        // We changed the base and 'k', the current index 'idx' is not longer valid,
-        // Thus, we update it:
+        // We changed the base and 'k', the current index 'idx' (walker's position 'pt')
+        // is not longer valid. Thus, we update it:
         idx = get_index( *pt );
-                
-        // ----------------------- PERCOLATE NEW (ADDED) SITES/NODES:
-        // We now have an array filled with '\0', '1' and '2'.
-        // We then search for these '2' values and replace them 
-        // with either '1' (visited) or '0' (not visited), such that 
-        // we have the following map:
-        // '1'  -> '1'  : already visited, no change
-        // '2'  -> '\0' : not visited previously, reverse back to '\0'
-        // '\0' -> '1'  : either percolated or '\0' (a new -not percolated- site/node)
-        // we browse the full array, which can be costly if 'nodes' is large:
-        
-        std::uniform_real_distribution<double> rand_p(0.0, 1.0);
-        
-        for(bigInt kn = 0; kn < nodes; kn++) {
-            // is site == '2', it means that it was already marked as (previously) not-visited
-            // we then reset its value to '0'
-            if( is_visited[kn] == '2' )
-                is_visited[kn] = '\0';
-            else 
-                // is site == '0', it's a new site, added during the resizing procedure of the lattice.
-                // we apply percolation:
-                if( is_visited[kn] == '\0' )
-                    if( rand_p(engine) < p_perco )
-                        is_visited[kn] = '1'; //percolated: considered as already visited ( = empty )
-        }
-        
-        delete pt;
-        free(index_not_visited);
-        free(index_visited);
     }
     
     // Either the walker is 'inside' or 'outside' the lattice, 
     // but the site can already be visited:
-    if(is_visited[idx] == '\0') {
-        is_visited[idx] = '1';
-        return true;
-    }
-    return false;
+    // (test_and_set() marks the node as visited and returns its previous state):
+    return is_visited.test_and_set( idx ) == false;
 }
 
 //------------------------------------------------------------------------------
 // Check if node is already visited, if not, mark it as visited.
-// We also check the node is inside the lattice, otherwise we increase its size by 'n_layers' layers (hardcoded value).
+// We also check the node is inside the lattice, otherwise we increase its size by 'n_layers' layers (see Lattice::get_n_layers()).
 // (Jump version)
 bool Lattice_baseconversion::check_new_node_jump(const PointND * pt) {
 
     bigInt idx = 0;
     unsigned n_layers = 0;
     bigInt to_add = 0;  // number of new nodes (or indexes in the array) to add.
-    // Sets a 'margin' variable which allows for some 'room' (i.e. additional layers of nodes) for latter jumps,
-    // this prevents entering the idx >= nodes conditions 'too often'.
-    const unsigned margin = 4;
     
     // we first gather the index of the position 'pt' in the 'visited' array:
     //std::cout << "get_index(): ";
@@ -367,8 +274,9 @@ bool Lattice_baseconversion::check_new_node_jump(const PointND * pt) {
     // Otherwise, we increase the size of the lattice:
     if( idx >= nodes ) {
         
-        //simply increase the number of layers by the max jump_size * margin
-        n_layers = max_jump_size * margin;
+        // increase the number of layers geometrically, and at least by max_jump_size
+        // (the walker is at most max_jump_size nodes outside the lattice):
+        n_layers = get_n_layers( max_jump_size );
         // or alternatively, compute the requested number of nodes to keep 
         // the walker inside the lattice using:
         // get_n_nodes_after_jump( *pt, n_layers );
@@ -377,7 +285,7 @@ bool Lattice_baseconversion::check_new_node_jump(const PointND * pt) {
         to_add = get_n_nodes( n_layers );
 
         // resize the lattice accordingly:
-        resize_lattice_carray( to_add, n_layers ); //for a c-style array implementation
+        resize_lattice_inplace( to_add, n_layers, NULL ); //in-place implementation
         // resize_lattice_vector( to_add, n_layers ); //alternative vector() implementation
         
         // We changed the base and 'k', the current index 'idx' is not longer valid,
@@ -386,11 +294,8 @@ bool Lattice_baseconversion::check_new_node_jump(const PointND * pt) {
     } 
 
     // Check whether the node at index 'idx' was previously visited or not:
-    if( is_visited[idx] == '\0' ) {
-        is_visited[idx] = '1';
-        return true;
-    } 
-    return false;
+    // (test_and_set() marks the node as visited and returns its previous state):
+    return is_visited.test_and_set( idx ) == false;
 }
 
 //------------------------------------------------------------------------------
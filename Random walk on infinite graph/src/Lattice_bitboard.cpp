@@ -0,0 +1,356 @@
+ /*==========================================================
+  * Lattice_bitboard class, derived from Lattice class
+  * The 'lattice' is a n-dimensional array of blocks, where each block
+  * of 64 nodes is packed into one 64-bit word of 'is_visited':
+  * 64 nodes (1D), 8x8 nodes (2D) or 4x4x4 nodes (3D).
+  * The blocks are indexed using a base conversion method (see Lattice_baseconversion),
+  * such that most steps of the walker stay inside the same (cached) word.
+  * A summary of the blocks is also maintained at several levels (as a quadtree in 2D, or an octree in 3D):
+  * for each cell of 64 blocks, 64x64 blocks, etc., which cells are fully visited or not visited at all,
+  * such that one knows in a few operations that the walker is deep inside a fully visited region
+  * (see is_full(), is_untouched() and get_full_level()).
+  *========================================================*/
+#include "Lattice_bitboard.hpp"
+
+/*==========================================================
+ * Lattice bitboard (derived class, see 'Lattice.hpp' for base class)
+ *========================================================*/
+//------------------------------------------------------------------------------
+// Constructor:
+Lattice_bitboard::Lattice_bitboard(const bigInt n_preys, const bigInt N0, const double lattice_size, const unsigned dim, const double percol_value, const unsigned x_max, const Bit_array::Storage storage, const double growth)
+:Lattice(n_preys, N0, lattice_size, dim, percol_value, x_max, storage, growth),
+    shift{ dim == 1 ? 6u : ( dim == 2 ? 3u : 2u ) },
+    mask{ ( (cInt) 1 << shift ) - 1 }
+{
+    // The initial lattice holds the nodes in [-k, k] in each dimension (see Lattice_baseconversion),
+    // we compute the number of blocks required to hold these nodes:
+    const cInt k = (cInt) (L_dim_size-1) / 2;
+    K = ( k + mask ) >> shift;
+    B = 2 * K + 1;
+
+    // the number of nodes is then a multiple of 64 (one word per block):
+    bigInt n_blocks = 1;
+    for( unsigned i = 0; i < L_dim; i++ )
+        n_blocks *= B;
+
+    nodes = n_blocks << 6;
+    is_visited.resize( nodes );
+    L_dim_size = B << shift;
+
+    rebuild_summary();
+}
+
+//------------------------------------------------------------------------------
+// The walker is outside the lattice, thus we resize the lattice.
+// 'n_layers' is the (minimal) number of nodes we add on each side of the lattice,
+// it is rounded up to a number of blocks.
+// The blocks of one row (first dimension) are contiguous in the old and the new lattice,
+// thus each row is moved at once to its new position, from the last row to the first one
+// (the new index of a row is never lower than its previous index), such that no temporary array is needed.
+// The 'gaps' between the moved rows are the new blocks: they are set to 0 or,
+// if 'engine' is not NULL, percolated.
+// The rows are written through Bit_array (move(), fill()), never through the raw words: the pages written are then
+// tracked, and cleared by reset() when the lattice is reused by the next simulation of the thread.
+void Lattice_bitboard::resize_lattice( const unsigned n_layers, std::mt19937_64 * engine ) {
+
+    const cInt old_K = K;
+    const bigInt old_B = B;
+    const bigInt old_rows = ( nodes >> 6 ) / old_B;
+
+    // update the number of blocks and nodes:
+    K += ( (cInt) n_layers + mask ) >> shift;
+    B = 2 * K + 1;
+
+    // the index of the last node (64 * B^dim - 1) must fit in a bigInt, this is checked here, once per resize
+    // (the index of a node outside of the lattice is not computed, see get_index()):
+    if( std::pow( (double) B, L_dim ) * 64.0 >= (double) std::numeric_limits<bigInt>::max() )
+        throw std::runtime_error("The walker is outside of the maximum lattice node. Change the type of ''bigInt'' in ''Config_types.hpp''");
+
+    bigInt n_blocks = 1;
+    for( unsigned i = 0; i < L_dim; i++ )
+        n_blocks *= B;
+
+    nodes = n_blocks << 6;
+    is_visited.resize( nodes );
+    L_dim_size = B << shift;
+
+    // ----------------------- MOVE THE PREVIOUS ROWS OF BLOCKS:
+    bigInt gap_end = n_blocks; // end of the gap above the current row
+    for( bigInt r = old_rows; r-- > 0; ) {
+
+        // get the coordinates of the row in the old base (dimensions 2 and 3), 
+        // and the index of its first block in the new base:
+        bigInt rem = r, w_new = 0, stride = B;
+        for( unsigned i = 1; i < L_dim; i++ ) {
+            const cInt c = (cInt) ( rem % old_B ) - old_K;
+            rem /= old_B;
+            w_new += (bigInt) ( c + K ) * stride;
+            stride *= B;
+        }
+        w_new += (bigInt) ( K - old_K ); // first block of the row (first dimension)
+
+        is_visited.move( w_new << 6, ( r * old_B ) << 6, old_B << 6 ); // (whole words, see Bit_array::move())
+        fill_new_blocks( w_new + old_B, gap_end, engine );
+        gap_end = w_new;
+    }
+    fill_new_blocks( 0, gap_end, engine );
+
+    // the blocks moved, and the cells of the summary changed:
+    rebuild_summary();
+}
+
+//------------------------------------------------------------------------------
+// Percolates the nodes of the lattice (see Lattice::percolate_init()), and updates the summary.
+void Lattice_bitboard::percolate_init( std::mt19937_64 & engine ) {
+    Lattice::percolate_init( engine );
+    rebuild_summary();
+}
+
+//------------------------------------------------------------------------------
+// Reset the lattice for a new simulation (see Lattice::reset()), and the summary.
+void Lattice_bitboard::reset() {
+    Lattice::reset();
+    for( unsigned l = 1; l < level_side.size(); l++ ) {
+        std::fill( full[l].begin(), full[l].end(), 0 );
+        std::fill( touched[l].begin(), touched[l].end(), 0 );
+    }
+}
+
+//------------------------------------------------------------------------------
+// Computes the summary of the blocks from scratch (after a resize of the lattice, or a percolation):
+// the number of cells on one side is divided by 8 (2D), 4 (3D) or 64 (1D) at each level, up to a single cell.
+void Lattice_bitboard::rebuild_summary() {
+
+    level_side.assign( 1, B );
+    while( level_side.back() > 1 )
+        level_side.push_back( ( level_side.back() + mask ) >> shift );
+
+    full.assign( level_side.size(), std::vector<uint64_t>() );
+    touched.assign( level_side.size(), std::vector<uint64_t>() );
+    for( unsigned l = 1; l < level_side.size(); l++ ) {
+        bigInt n_cells = 1;
+        for( unsigned i = 0; i < L_dim; i++ )
+            n_cells *= level_side[l];
+        full[l].assign( n_cells, 0 );
+        touched[l].assign( n_cells, 0 );
+    }
+
+    const uint64_t * words = is_visited.data();
+    const bigInt n_blocks = nodes >> 6;
+    for( bigInt w = 0; w < n_blocks; w++ ) {
+        if( words[w] == 0 )
+            continue;
+
+        cInt c[3] = { 0, 0, 0 };
+        bigInt rem = w;
+        for( unsigned i = 0; i < L_dim; i++ ) {
+            c[i] = (cInt) ( rem % B );
+            rem /= B;
+        }
+        mark_block( c, true, words[w] == ~0ULL );
+    }
+}
+
+//------------------------------------------------------------------------------
+// Updates the summary after the visit of a new node 'pt' (bit 'idx'):
+// only when its block becomes touched (first visited node) or full (last node).
+void Lattice_bitboard::update_summary( const PointND & pt, const bigInt idx ) {
+
+    const uint64_t w = is_visited.data()[idx >> 6];
+    const bool first = w == ( 1ULL << ( idx & 63 ) );
+    const bool last = w == ~0ULL;
+    if( first == false && last == false )
+        return;
+
+    cInt c[3] = { 0, 0, 0 };
+    for( unsigned i = 0; i < L_dim; i++ )
+        c[i] = ( pt[i] >> shift ) + K;
+    mark_block( c, first, last );
+}
+
+//------------------------------------------------------------------------------
+// Marks the block with (positive) coordinates 'c' as touched and/or full in its parent cell, and so on:
+// a parent is marked in turn if it becomes touched (its first child touched) or full (all its children full).
+void Lattice_bitboard::mark_block( cInt * c, bool is_touched, bool is_full ) {
+
+    for( unsigned l = 1; l < level_side.size() && ( is_touched || is_full ); l++ ) {
+        unsigned bit = 0;   // position of the child in its parent cell
+        bigInt cell = 0;    // index of the parent cell
+        for( unsigned i = L_dim; i-- > 0; ) {
+            bit = ( bit << shift ) | (unsigned) ( c[i] & mask );
+            c[i] >>= shift;
+            cell = cell * level_side[l] + (bigInt) c[i];
+        }
+
+        if( is_touched ) {
+            is_touched = touched[l][cell] == 0;
+            touched[l][cell] |= 1ULL << bit;
+        }
+        if( is_full ) {
+            full[l][cell] |= 1ULL << bit;
+            is_full = full[l][cell] == ~0ULL;
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+// Returns the number of levels of the summary (level 0: the blocks of 64 nodes).
+unsigned Lattice_bitboard::get_n_levels() const {
+    return level_side.size();
+}
+
+//------------------------------------------------------------------------------
+// Returns the number of nodes on one side of a cell of level 'l' (8^(l+1) in 2D, 4^(l+1) in 3D, 64^(l+1) in 1D).
+bigInt Lattice_bitboard::get_cell_side( const unsigned l ) const {
+    return 1ULL << ( shift * ( l + 1 ) );
+}
+
+//------------------------------------------------------------------------------
+// Returns the index of the cell of level 'l' (l >= 1) holding the node 'pt',
+// or the number of cells if the node is outside the lattice.
+bigInt Lattice_bitboard::get_cell( const PointND & pt, const unsigned l ) const {
+
+    bigInt cell = 0;
+    for( unsigned i = L_dim; i-- > 0; ) {
+        const cInt c = pt[i] >> shift;
+        if( c < -K || c > K )
+            return full[l].size();
+        cell = cell * level_side[l] + (bigInt) ( ( c + K ) >> ( shift * l ) );
+    }
+    return cell;
+}
+
+//------------------------------------------------------------------------------
+// Returns true if all the nodes of the cell of level 'l' holding 'pt' are visited
+// (false if the node is outside the lattice).
+// Note that a cell on the border of the lattice (partly outside) is never full.
+bool Lattice_bitboard::is_full( const PointND & pt, const unsigned l ) const {
+
+    if( l == 0 ) {
+        const bigInt idx = get_index( pt );
+        return idx < nodes && is_visited.data()[idx >> 6] == ~0ULL;
+    }
+    if( l >= level_side.size() )
+        return false;
+
+    const bigInt cell = get_cell( pt, l );
+    return cell < full[l].size() && full[l][cell] == ~0ULL;
+}
+
+//------------------------------------------------------------------------------
+// Returns true if no node of the cell of level 'l' holding 'pt' is visited
+// (true if the node is outside the lattice).
+bool Lattice_bitboard::is_untouched( const PointND & pt, const unsigned l ) const {
+
+    if( l == 0 ) {
+        const bigInt idx = get_index( pt );
+        return idx >= nodes || is_visited.data()[idx >> 6] == 0;
+    }
+    if( l >= level_side.size() )
+        return false;
+
+    const bigInt cell = get_cell( pt, l );
+    return cell >= touched[l].size() || touched[l][cell] == 0;
+}
+
+//------------------------------------------------------------------------------
+// Returns the number of nested cells holding 'pt' that are fully visited, i.e.
+// 0 if the block of 'pt' is not full, 1 if its block is full, 2 if its cell of level 1 is full, and so on.
+// The walker is then at least ( get_cell_side( level - 1 ) / 2 ) nodes away from a node not visited, in the worst case
+// of a node on the border of its cell.
+unsigned Lattice_bitboard::get_full_level( const PointND & pt ) const {
+    unsigned l = 0;
+    while( l < level_side.size() && is_full( pt, l ) )
+        l++;
+    return l;
+}
+
+//------------------------------------------------------------------------------
+// Initializes the new blocks in [w_start, w_end) (words) after a resize of the lattice:
+// they are either set to 0 (not visited), or percolated if 'engine' is not NULL.
+void Lattice_bitboard::fill_new_blocks( const bigInt w_start, const bigInt w_end, std::mt19937_64 * engine ) {
+
+    if( w_end <= w_start )
+        return;
+
+    if( engine == NULL )
+        is_visited.fill( w_start << 6, w_end << 6, false );
+    else
+        percolate_new( w_start << 6, w_end << 6, *engine );
+}
+
+//------------------------------------------------------------------------------
+// Check if node is already visited, if not, mark it as visited.
+// We also check the node is inside the lattice, otherwise we increase its size (see Lattice::get_n_layers()).
+bool Lattice_bitboard::check_new_node(const PointND * pt) {
+
+    bigInt idx = get_index( *pt );
+    if( idx >= nodes ) {
+        resize_lattice( get_n_layers( 1 ), NULL );
+        idx = get_index( *pt ); // the base changed, thus we update the index
+    }
+
+    // (test_and_set() marks the node as visited and returns its previous state):
+    if( is_visited.test_and_set( idx ) )
+        return false;
+    update_summary( *pt, idx );
+    return true;
+}
+
+//------------------------------------------------------------------------------
+// Check if node is already visited, if not, mark it as visited.
+// We also check the node is inside the lattice, otherwise we increase its size (see Lattice::get_n_layers()).
+// (Percolation version)
+bool Lattice_bitboard::check_new_node(const PointND * pt, std::mt19937_64 & engine) {
+
+    bigInt idx = get_index( *pt );
+    if( idx >= nodes ) {
+        resize_lattice( get_n_layers( 1 ), &engine ); // the new blocks are percolated
+        idx = get_index( *pt );
+    }
+
+    // In the case of percolation a new site can already be marked as 'visited':
+    if( is_visited.test_and_set( idx ) )
+        return false;
+    update_summary( *pt, idx );
+    return true;
+}
+
+//------------------------------------------------------------------------------
+// Check if node is already visited, if not, mark it as visited.
+// We also check the node is inside the lattice, otherwise we increase its size by at least max_jump_size layers.
+// (Jump version)
+bool Lattice_bitboard::check_new_node_jump(const PointND * pt) {
+
+    bigInt idx = get_index( *pt );
+    while( idx >= nodes ) {
+        resize_lattice( get_n_layers( max_jump_size ), NULL );
+        idx = get_index( *pt );
+    }
+
+    if( is_visited.test_and_set( idx ) )
+        return false;
+    update_summary( *pt, idx );
+    return true;
+}
+
+//------------------------------------------------------------------------------
+// Returns the index of the bit from a n-Dimensional position:
+// index = 64 * (index of the block) + (index of the node inside the block),
+// where both indexes follow Horner's method (x + side * (y + side * z)).
+bigInt Lattice_bitboard::get_index(const PointND &pt) const {
+
+    unsigned long long int w = 0;   // index of the block (word)
+    unsigned long long int b = 0;   // index of the node inside the block (bit)
+
+    for( unsigned i = L_dim; i-- > 0; ) {
+        const cInt c = pt[i] >> shift;  // block coordinate (arithmetic shift, i.e. floor division)
+        if( c < -K || c > K )
+            return nodes + 1;   // notify check_new_node() that the walker is outside the lattice.
+
+        w = w * B + (bigInt) ( c + K );
+        b = ( b << shift ) | (bigInt) ( pt[i] & mask );
+    }
+
+    return (bigInt) ( ( w << 6 ) | b );
+}
@@ -0,0 +1,170 @@
+ /*==========================================================
+  * Lattice_hashset class, derived from Lattice class
+  * The visited nodes are stored in a hash set (open addressing, linear probing) keyed by their coordinates,
+  * instead of a dense array of the bounding lattice.
+  * The memory is thus proportional to the number of distinct visited nodes, whatever the extent of the walk,
+  * which suits the walks with long jumps (see Step_jump), where the walker visits a sparse cloud of nodes
+  * in a very large volume (e.g. in 3D with a large 'power_law_xmax').
+  * The keys are the coordinates packed into 64 bits (64, 32 or 21 bits per coordinate),
+  * and 4 slots are compared at once (AVX2 if available, see 'makefile.complete').
+  *========================================================*/
+#include "Lattice_hashset.hpp"
+
+/*==========================================================
+ * Lattice hashset (derived class, see 'Lattice.hpp' for base class)
+ *========================================================*/
+//------------------------------------------------------------------------------
+// Constructor:
+// The bits of the base class are not used (a single node is allocated), N0 is ignored: the table starts
+// with 2^init_bits slots and doubles its size when it is half full.
+Lattice_hashset::Lattice_hashset(const bigInt n_preys, const bigInt N0, const double lattice_size, const unsigned dim, const double percol_value, const unsigned x_max, const Bit_array::Storage storage, const double growth)
+:Lattice(n_preys, 1, lattice_size, dim, percol_value, x_max, storage, growth),
+    key_bits{ 64 / dim },
+    table( 1ULL << init_bits, 0 )
+{
+    nodes = table.size();
+}
+
+//------------------------------------------------------------------------------
+// Check if node is already visited, if not, mark it as visited.
+bool Lattice_hashset::check_new_node(const PointND * pt) {
+    return insert( get_key( *pt ), NULL );
+}
+
+//------------------------------------------------------------------------------
+// Check if node is already visited, if not, mark it as visited.
+// (Percolation version: a node is percolated the first time the walker reaches it, see percolate_init())
+bool Lattice_hashset::check_new_node(const PointND * pt, std::mt19937_64 & engine) {
+    return insert( get_key( *pt ), &engine );
+}
+
+//------------------------------------------------------------------------------
+// Check if node is already visited, if not, mark it as visited.
+// The table does not depend on the length of the jump.
+// (Jump version)
+bool Lattice_hashset::check_new_node_jump(const PointND * pt) {
+    return insert( get_key( *pt ), NULL );
+}
+
+//------------------------------------------------------------------------------
+// The nodes are not percolated at start (there is no lattice to percolate):
+// each node is percolated the first time the walker reaches it (see insert()),
+// which gives the same distribution since the nodes are percolated independently.
+void Lattice_hashset::percolate_init( std::mt19937_64 & ) {}
+
+//------------------------------------------------------------------------------
+// Reset the lattice for a new simulation: the table is emptied, its size is kept.
+void Lattice_hashset::reset() {
+    Lattice::reset();
+    std::fill( table.begin(), table.end(), 0 );
+    n_keys = 0;
+}
+
+//------------------------------------------------------------------------------
+// Return the size of the table (bytes)
+bigInt Lattice_hashset::get_memory_bytes() const {
+    return table.size() * sizeof(uint64_t);
+}
+
+//------------------------------------------------------------------------------
+// Adds the node 'key' to the table and returns true if it was not visited before.
+// If 'engine' is not NULL, a new node is percolated: it is empty (already visited) with probability p_perco.
+bool Lattice_hashset::insert( const uint64_t key, std::mt19937_64 * engine ) {
+
+    bool found = false;
+    bigInt slot = find_slot( key, found );
+    if( found )
+        return false;
+
+    if( 2 * ( n_keys + 1 ) > table.size() ) {
+        grow();
+        slot = find_slot( key, found );
+    }
+    table[slot] = key;
+    n_keys++;
+
+    if( engine != NULL ) {
+        std::uniform_real_distribution<double> rand_p(0.0, 1.0);
+        if( rand_p(*engine) < p_perco )
+            return false; //empty site
+    }
+    return true;
+}
+
+//------------------------------------------------------------------------------
+// Returns the slot holding 'key' (found = true), or the first empty slot where 'key' can be inserted (found = false).
+// The slots are probed by groups of 4, starting from the group given by the hash of the key.
+// Since the keys are never removed (until reset()), the key is not in the table once an empty slot is reached.
+// Note that the loop always ends, as the table is at most half full.
+bigInt Lattice_hashset::find_slot( const uint64_t key, bool & found ) const {
+
+    const bigInt mask = table.size() - 1;
+    bigInt g = hash( key ) & mask & ~( (bigInt) group - 1 );
+
+    while( true ) {
+        const uint64_t * s = &table[g];
+#ifdef __AVX2__
+        const __m256i v = _mm256_loadu_si256( (const __m256i *) s );
+        const unsigned eq = _mm256_movemask_pd( _mm256_castsi256_pd( _mm256_cmpeq_epi64( v, _mm256_set1_epi64x( (long long) key ) ) ) );
+        const unsigned empty = _mm256_movemask_pd( _mm256_castsi256_pd( _mm256_cmpeq_epi64( v, _mm256_setzero_si256() ) ) );
+#else
+        unsigned eq = 0, empty = 0;
+        for( unsigned j = 0; j < group; j++ ) {
+            eq |= (unsigned) ( s[j] == key ) << j;
+            empty |= (unsigned) ( s[j] == 0 ) << j;
+        }
+#endif
+        if( eq != 0 ) {
+            found = true;
+            return g + __builtin_ctz( eq );
+        }
+        if( empty != 0 ) {
+            found = false;
+            return g + __builtin_ctz( empty );
+        }
+        g = ( g + group ) & mask;
+    }
+}
+
+//------------------------------------------------------------------------------
+// Doubles the number of slots, and inserts the keys again in the new table:
+void Lattice_hashset::grow() {
+
+    std::vector<uint64_t> old( table.size() * 2, 0 );
+    old.swap( table );
+    nodes = table.size();
+
+    bool found = false;
+    for( const uint64_t key : old )
+        if( key != 0 )
+            table[ find_slot( key, found ) ] = key;
+}
+
+//------------------------------------------------------------------------------
+// Returns the key of the node 'pt', i.e. its coordinates packed into 64 bits (64, 32 or 21 bits per coordinate).
+// The coordinates are shifted by 2^(key_bits-1), such that no node has the key 0 (empty slot).
+uint64_t Lattice_hashset::get_key( const PointND & pt ) const {
+
+    if( key_bits == 64 )
+        return (uint64_t) pt[0] ^ ( 1ULL << 63 ); //(the node -2^63 is never reached)
+
+    const cInt half = (cInt) 1 << ( key_bits - 1 );
+    uint64_t key = 0;
+    for( unsigned i = 0; i < L_dim; i++ ) {
+        if( pt[i] >= half || pt[i] <= -half )
+            throw std::runtime_error("The walker is outside of the maximum coordinate (see Lattice_hashset::get_key())");
+
+        key = ( key << key_bits ) | (uint64_t) ( pt[i] + half );
+    }
+    return key;
+}
+
+//------------------------------------------------------------------------------
+// Returns the slot of the node 'pt' in the table,
+// or nodes + 1 if the node was not visited yet.
+bigInt Lattice_hashset::get_index( const PointND & pt ) const {
+
+    bool found = false;
+    const bigInt slot = find_slot( get_key( pt ), found );
+    return found ? slot : nodes + 1;
+}
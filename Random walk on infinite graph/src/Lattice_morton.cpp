@@ -0,0 +1,131 @@
+ /*==========================================================
+  * Lattice_morton class, derived from Lattice class
+  * The nodes are indexed in Z-order (or Morton order): the bits of the coordinates are interleaved,
+  * such that the neighbours of a node in every dimension are close in 'is_visited'
+  * (unlike a row-major index, where a step in y or z jumps by a whole row or plane of nodes).
+  * The coordinates are first mapped to N by blocks (see Lattice_morton::code()): the blocks of 2^block_bits nodes
+  * per side are in zigzag order (0, -1, 1, -2, ... -> 0, 1, 2, 3, ...), and the nodes of a block keep their order,
+  * such that the lattice with 2^b codes per side holds the indexes [0, 2^(b*dim)):
+  * adding one bit per coordinate only appends new nodes at the end of 'is_visited' (no remap).
+  * As the Z-order is nested, an aligned range of indexes inside a block is a block of space:
+  * a 64-bit word holds 64 (1D), 8x8 (2D) or 4x4x4 (3D) neighbour nodes, a cache line 512, 32x16 or 8x8x8 nodes,
+  * and a block holds 2^15 nodes (1D), 128x128 (2D) or 32x32x32 (3D), i.e. one (or half a) page of 4 KB.
+  * (the zigzag of the coordinates themselves would mirror the blocks: a word would hold 2x2x2 blocks of nodes
+  * from opposite sides of the origin)
+  *========================================================*/
+#include "Lattice_morton.hpp"
+
+/*==========================================================
+ * Lattice morton (derived class, see 'Lattice.hpp' for base class)
+ *========================================================*/
+//------------------------------------------------------------------------------
+// Constructor:
+Lattice_morton::Lattice_morton(const bigInt n_preys, const bigInt N0, const double lattice_size, const unsigned dim, const double percol_value, const unsigned x_max, const Bit_array::Storage storage, const double growth)
+:Lattice(n_preys, N0, lattice_size, dim, percol_value, x_max, storage, growth) {
+
+    // a block is (at most) a page of 4 KB (2^15 nodes):
+    block_bits = L_dim == 1 ? 15 : ( L_dim == 2 ? 7 : 5 );
+
+    // The initial lattice holds (at least) the nodes in [-k, k] in each dimension (see Lattice_baseconversion),
+    // i.e. the codes in [0, 2^side_bits) with 2^(side_bits-1) > k, and (at least) the two blocks around the origin:
+    const bigInt k = ( L_dim_size - 1 ) / 2;
+    side_bits = block_bits + 1;
+    while( ( 1ULL << ( side_bits - 1 ) ) <= k )
+        side_bits++;
+
+    resize_lattice( side_bits, NULL );
+}
+
+//------------------------------------------------------------------------------
+// Resizes the lattice to 'n_bits' bits per coordinate code, i.e. 2^(n_bits*dim) nodes.
+// The new nodes are appended at the end of 'is_visited' (initialized to 0),
+// and percolated if 'engine' is not NULL.
+// Note that the lattice grows by a factor 2 in each dimension (the growth factor of the lattice is not used).
+void Lattice_morton::resize_lattice( const unsigned n_bits, std::mt19937_64 * engine ) {
+
+    if( n_bits * L_dim > 63 )
+        throw std::runtime_error("The walker is outside of the maximum Morton index (see Lattice_morton::resize_lattice())");
+
+    const bigInt old_nodes = nodes;
+
+    side_bits = n_bits;
+    nodes = 1ULL << ( side_bits * L_dim );
+    is_visited.resize( nodes ); //new nodes are initialized to 0 (not visited)
+
+    // the lattice holds all the nodes with |x| < 2^(side_bits-1) (and x = -2^(side_bits-1)):
+    L_dim_size = ( 1ULL << side_bits ) - 1;
+
+    if( engine != NULL && nodes > old_nodes )
+        percolate_new( old_nodes, nodes, *engine );
+}
+
+//------------------------------------------------------------------------------
+// Returns the number of bits required to hold the codes of the coordinates of 'pt':
+unsigned Lattice_morton::get_side_bits( const PointND & pt ) const {
+
+    uint64_t z = 0;
+    for( unsigned i = 0; i < L_dim; i++ )
+        z |= code( pt[i] );
+
+    unsigned n_bits = side_bits;
+    while( ( z >> n_bits ) != 0 )
+        n_bits++;
+    return n_bits;
+}
+
+//------------------------------------------------------------------------------
+// Check if node is already visited, if not, mark it as visited.
+// We also check the node is inside the lattice, otherwise we add one bit (or more) per coordinate.
+bool Lattice_morton::check_new_node(const PointND * pt) {
+
+    bigInt idx = get_index( *pt );
+    if( idx >= nodes ) {
+        resize_lattice( get_side_bits( *pt ), NULL );
+        idx = get_index( *pt );
+    }
+
+    // (test_and_set() marks the node as visited and returns its previous state):
+    return is_visited.test_and_set( idx ) == false;
+}
+
+//------------------------------------------------------------------------------
+// Check if node is already visited, if not, mark it as visited.
+// We also check the node is inside the lattice, otherwise we add one bit (or more) per coordinate.
+// (Percolation version: only the new nodes are percolated)
+bool Lattice_morton::check_new_node(const PointND * pt, std::mt19937_64 & engine) {
+
+    bigInt idx = get_index( *pt );
+    if( idx >= nodes ) {
+        resize_lattice( get_side_bits( *pt ), &engine );
+        idx = get_index( *pt );
+    }
+
+    // In the case of percolation a new site can already be marked as 'visited':
+    return is_visited.test_and_set( idx ) == false;
+}
+
+//------------------------------------------------------------------------------
+// Check if node is already visited, if not, mark it as visited.
+// We also check the node is inside the lattice, otherwise we add the bits required by the jump.
+// (Jump version)
+bool Lattice_morton::check_new_node_jump(const PointND * pt) {
+    return check_new_node( pt );
+}
+
+//------------------------------------------------------------------------------
+// Returns the Morton index of a n-Dimensional position,
+// or nodes + 1 if the position is outside the lattice:
+// index = spread(cx) | spread(cy) << 1 | spread(cz) << 2, where cx, cy, cz are the codes of the coordinates.
+bigInt Lattice_morton::get_index( const PointND & pt ) const {
+
+    uint64_t p = 0;
+    for( unsigned i = 0; i < L_dim; i++ ) {
+        const uint64_t c = code( pt[i] );
+        if( ( c >> side_bits ) != 0 )
+            return nodes + 1;   // notify check_new_node() that the walker is outside the lattice.
+
+        p |= spread( c, L_dim ) << i;
+    }
+
+    return (bigInt) p;
+}
@@ -0,0 +1,62 @@
+ /*==========================================================
+  * Lattice_range class, derived from Lattice class
+  * In 1D, a walker moving to a neighbour node at each step (standard, drifted and memory walks)
+  * has visited all the nodes between the minimal and the maximal positions reached: the visited nodes are
+  * the interval [lo, hi], and a node is new only when the walker extends the interval.
+  * Thus, no node is stored (the memory does not depend on the walk) and the lattice is never resized.
+  * The walks with jumps or in a percolated lattice do not visit an interval: they use another lattice
+  * (see Config_params::get_lattice()).
+  *========================================================*/
+#include "Lattice_range.hpp"
+
+/*==========================================================
+ * Lattice range (derived class, see 'Lattice.hpp' for base class)
+ *========================================================*/
+//------------------------------------------------------------------------------
+// Constructor:
+// The bits of the base class are not used (a single node is allocated), N0 is ignored.
+Lattice_range::Lattice_range(const bigInt n_preys, const bigInt N0, const double lattice_size, const unsigned dim, const double percol_value, const unsigned x_max, const Bit_array::Storage storage, const double growth)
+:Lattice(n_preys, 1, lattice_size, dim, percol_value, x_max, storage, growth) {
+
+    if( dim != 1 )
+        throw std::runtime_error("Lattice_range: the dimension of the lattice must be 1");
+
+    nodes = 0;
+    L_dim_size = 0;
+}
+
+//------------------------------------------------------------------------------
+// (see 'Lattice_range.hpp' for check_new_node())
+//------------------------------------------------------------------------------
+// (Percolation version: the visited nodes of a percolated lattice are not an interval)
+bool Lattice_range::check_new_node(const PointND *, std::mt19937_64 &) {
+    throw std::runtime_error("Lattice_range: percolation is not supported (see Config_params::get_lattice())");
+}
+
+//------------------------------------------------------------------------------
+// (Jump version: the visited nodes of a walk with jumps are not an interval)
+bool Lattice_range::check_new_node_jump(const PointND *) {
+    throw std::runtime_error("Lattice_range: jumps are not supported (see Config_params::get_lattice())");
+}
+
+//------------------------------------------------------------------------------
+// Reset the lattice for a new simulation: no node is visited.
+void Lattice_range::reset() {
+    lo = 0;
+    hi = -1;
+    nodes = 0;
+    L_dim_size = 0;
+}
+
+//------------------------------------------------------------------------------
+// No node is stored (the bounds of the interval only):
+bigInt Lattice_range::get_memory_bytes() const {
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+// Returns the index of the node 'pt' in the interval,
+// or nodes + 1 if the node was not visited yet.
+bigInt Lattice_range::get_index( const PointND & pt ) const {
+    return pt[0] >= lo && pt[0] <= hi ? (bigInt) ( pt[0] - lo ) : nodes + 1;
+}
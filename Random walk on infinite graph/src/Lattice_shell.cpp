@@ -0,0 +1,149 @@
+ /*==========================================================
+  * Lattice_shell class, derived from Lattice class
+  * The nodes are indexed shell by shell (or 'onion' indexation),
+  * where the shell 'r' holds the nodes with max(|x|, |y|, |z|) = r.
+  * The shells are stored one after the other, such that the nodes of a lattice of radius R
+  * have indexes in [0, (2R+1)^d), and growing the lattice only appends new shells at the end
+  * of 'is_visited' (no remap of the visited nodes, unlike Lattice_baseconversion).
+  * This generalizes the spiral indexation (see Lattice_spiral) to dimensions 1 and 3.
+  *========================================================*/
+#include "Lattice_shell.hpp"
+
+/*==========================================================
+ * Lattice shell (derived class, see 'Lattice.hpp' for base class)
+ *========================================================*/
+//------------------------------------------------------------------------------
+// Constructor:
+Lattice_shell::Lattice_shell(const bigInt n_preys, const bigInt N0, const double lattice_size, const unsigned dim, const double percol_value, const unsigned x_max, const Bit_array::Storage storage, const double growth)
+:Lattice(n_preys, N0, lattice_size, dim, percol_value, x_max, storage, growth) {
+
+    // The initial lattice holds the nodes in [-R, R] in each dimension:
+    R = (cInt) (L_dim_size-1) / 2;
+    L_dim_size = 2 * R + 1;
+
+    nodes = 1;
+    for( unsigned i = 0; i < L_dim; i++ )
+        nodes *= L_dim_size;
+    is_visited.resize( nodes );
+}
+
+//------------------------------------------------------------------------------
+// The walker is outside the lattice, thus we resize the lattice
+// such that it holds the shells up to 'r'.
+// The new shells are appended at the end of 'is_visited' (their nodes are initialized to 0),
+// and percolated if 'engine' is not NULL.
+void Lattice_shell::resize_lattice( const cInt r, std::mt19937_64 * engine ) {
+
+    const bigInt old_nodes = nodes;
+
+    // The indexes of the new lattice, and of the nodes the walker can reach outside of it before the next resize
+    // (one step or one jump), must fit in their types (the spiral index is computed in a cInt, see Lattice_spiral):
+    // this is checked here, once per resize, rather than for each index at each step:
+    const double max_side = 2.0 * ( r + max_jump_size + 1 ) + 1.0;
+    if( std::pow( max_side, L_dim ) >= (double) std::numeric_limits<cInt>::max() )
+        throw std::runtime_error("The walker is outside of the maximum lattice node. Change the type of ''bigInt'' and ''cInt'' in ''Config_types.hpp''");
+
+    R = r;
+    L_dim_size = 2 * R + 1;
+
+    nodes = 1;
+    for( unsigned i = 0; i < L_dim; i++ )
+        nodes *= L_dim_size;
+    is_visited.resize( nodes );
+
+    if( engine != NULL )
+        percolate_new( old_nodes, nodes, *engine );
+}
+
+//------------------------------------------------------------------------------
+// Check if node is already visited, if not, mark it as visited.
+// We also check the node is inside the lattice, otherwise we increase its size (see Lattice::get_n_layers()).
+bool Lattice_shell::check_new_node(const PointND * pt) {
+
+    const bigInt idx = get_index( *pt );
+    if( idx >= nodes )
+        resize_lattice( get_radius( *pt ) + get_n_layers( 1 ), NULL ); // the index of the node is unchanged
+
+    // (test_and_set() marks the node as visited and returns its previous state):
+    return is_visited.test_and_set( idx ) == false;
+}
+
+//------------------------------------------------------------------------------
+// Check if node is already visited, if not, mark it as visited.
+// We also check the node is inside the lattice, otherwise we increase its size (see Lattice::get_n_layers()).
+// (Percolation version: only the new shells are percolated)
+bool Lattice_shell::check_new_node(const PointND * pt, std::mt19937_64 & engine) {
+
+    const bigInt idx = get_index( *pt );
+    if( idx >= nodes )
+        resize_lattice( get_radius( *pt ) + get_n_layers( 1 ), &engine );
+
+    // In the case of percolation a new site can already be marked as 'visited':
+    return is_visited.test_and_set( idx ) == false;
+}
+
+//------------------------------------------------------------------------------
+// Check if node is already visited, if not, mark it as visited.
+// We also check the node is inside the lattice, otherwise we increase its size (see Lattice::get_n_layers()).
+// (Jump version)
+bool Lattice_shell::check_new_node_jump(const PointND * pt) {
+
+    const bigInt idx = get_index( *pt );
+    if( idx >= nodes )
+        resize_lattice( get_radius( *pt ) + get_n_layers( max_jump_size ), NULL );
+
+    return is_visited.test_and_set( idx ) == false;
+}
+
+//------------------------------------------------------------------------------
+// Returns the shell of the node 'pt', i.e. max(|x|, |y|, |z|):
+cInt Lattice_shell::get_radius( const PointND & pt ) const {
+
+    cInt r = 0;
+    for( unsigned i = 0; i < L_dim; i++ )
+        r = std::max( r, pt[i] < 0 ? -pt[i] : pt[i] );
+    return r;
+}
+
+//------------------------------------------------------------------------------
+// Returns the shell index of a n-Dimensional position.
+// The nodes of shell 'r' have indexes in [(2r-1)^d, (2r+1)^d), with:
+// 1D: the nodes are interleaved: 0, 1, -1, 2, -2, ... ( i.e. 2x-1 if x > 0, -2x otherwise ),
+// 2D: spiral index (see Lattice_spiral),
+// 3D: the shell 'r' is the surface of a cube of side 2r+1, and is stored in the following order:
+//     - the bottom face (z = -r) and the top face (z = r), row by row ( (2r+1)^2 nodes each ),
+//     - the rings of the 2r-1 intermediate levels (-r < z < r), where each ring of 8r nodes
+//       follows the spiral order of the ring 'r' in 2D.
+// Note that no bound checking is needed: a node outside of the lattice has an index >= nodes.
+bigInt Lattice_shell::get_index( const PointND & pt ) const {
+
+    unsigned long long int p = 0;
+
+    //1-dimensional
+    if( L_dim == 1 )
+        p = pt[0] > 0 ? 2 * pt[0] - 1 : -2 * pt[0];
+    else
+        //2-dimensional
+        if( L_dim == 2 )
+            p = Lattice_spiral::get_spiral_index( pt[0], pt[1] );
+        else {
+            //3-dimensional
+            const cInt r = get_radius( pt );
+            if( r > 0 ) {
+                const unsigned long long int side = 2 * r + 1;     // number of nodes on one side of the shell
+                const unsigned long long int inner = 2 * r - 1;    // number of nodes on one side of the previous shell
+
+                p = inner * inner * inner; // first index of the shell 'r'
+
+                if( pt[2] == -r )       // bottom face
+                    p += ( pt[0] + r ) + side * ( pt[1] + r );
+                else if( pt[2] == r )   // top face
+                    p += side * side + ( pt[0] + r ) + side * ( pt[1] + r );
+                else                    // intermediate rings
+                    p += 2 * side * side + ( pt[2] + r - 1 ) * 8 * r
+                        + Lattice_spiral::get_spiral_index( pt[0], pt[1] ) - inner * inner;
+            }
+        }
+
+    return (bigInt) p;
+}
@@ -0,0 +1,226 @@
+ /*==========================================================
+  * Lattice_sparse class, derived from Lattice class
+  * The visited nodes are stored in tiles of 64 nodes (64 in 1D, 8x8 in 2D, 4x4x4 in 3D) packed into one 64-bit word,
+  * and the tiles in a hash table (open addressing) keyed by the coordinates of the tiles.
+  * A tile is added the first time the walker enters it, so the memory is proportional to the number of distinct
+  * visited nodes, instead of the volume of the cube around the walk: in 3D, the walk is transient and
+  * visits O(n) nodes in a cube of O(n^(3/2)) nodes.
+  * The table is fronted by a blocked Bloom filter (one cache line per key), which tells that a tile is new
+  * without probing the table, and by a cache of the last tile (most steps stay inside the same tile).
+  *========================================================*/
+#include "Lattice_sparse.hpp"
+
+/*==========================================================
+ * Lattice sparse (derived class, see 'Lattice.hpp' for base class)
+ *========================================================*/
+//------------------------------------------------------------------------------
+// Constructor:
+// The bits of the base class are not used (a single node is allocated), N0 is ignored: the table starts
+// with 2^init_bits groups of slots and doubles its size when it is half full.
+Lattice_sparse::Lattice_sparse(const bigInt n_preys, const bigInt N0, const double lattice_size, const unsigned dim, const double percol_value, const unsigned x_max, const Bit_array::Storage storage, const double growth)
+:Lattice(n_preys, 1, lattice_size, dim, percol_value, x_max, storage, growth),
+    shift{ 6 / dim },
+    mask{ ( (cInt) 1 << ( 6 / dim ) ) - 1 },
+    key_bits{ 64 / dim }
+{
+    allocate( 1ULL << init_bits );
+}
+
+//------------------------------------------------------------------------------
+// (see 'Lattice_sparse.hpp' for check_new_node() and visit())
+//------------------------------------------------------------------------------
+// The nodes are not percolated at start (there is no lattice to percolate):
+// the 64 nodes of a tile are percolated when the tile is added (see new_tile()),
+// which gives the same distribution since the nodes are percolated independently.
+void Lattice_sparse::percolate_init( std::mt19937_64 & ) {}
+
+//------------------------------------------------------------------------------
+// Reset the lattice for a new simulation: the table and the filter are emptied, their sizes are kept.
+void Lattice_sparse::reset() {
+    Lattice::reset();
+    std::fill( storage.begin(), storage.end(), 0 );
+    std::fill( bloom.begin(), bloom.end(), 0 );
+    n_tiles = 0;
+    last_key = 0;
+    last_tile = NULL;
+}
+
+//------------------------------------------------------------------------------
+// Return the size of the table and of the filter (bytes)
+bigInt Lattice_sparse::get_memory_bytes() const {
+    return ( storage.size() + bloom.size() ) * sizeof(uint64_t);
+}
+
+//------------------------------------------------------------------------------
+// The walker enters the tile 'key' (holding the node 'pt'), which becomes the last tile accessed (see visit()).
+// The tile is added if it is not in the table (percolated if 'engine' is not NULL, see new_tile()).
+// The range of the coordinates is checked here (once per tile entered) rather than at each step.
+void Lattice_sparse::enter_tile( const PointND & pt, const uint64_t key, std::mt19937_64 * engine ) {
+
+    check_key( pt );
+    const uint64_t h = hash( key );
+    uint64_t * tile = bloom_test( h ) ? find_tile( key, h ) : NULL;
+    if( tile == NULL )
+        tile = new_tile( key, h, engine );
+    last_key = key;
+    last_tile = tile;
+}
+
+//------------------------------------------------------------------------------
+// Returns the tile 'key' (of hash 'h'), or NULL if the tile is not in the table
+// (a false positive of the filter).
+uint64_t * Lattice_sparse::find_tile( const uint64_t key, const uint64_t h ) {
+
+    bool found = false;
+    const bigInt slot = find_slot( key, h, found );
+    return found ? &table[slot / group].tile[slot % group] : NULL;
+}
+
+//------------------------------------------------------------------------------
+// Adds the tile 'key' (of hash 'h'), which is not in the table, and returns it.
+// If 'engine' is not NULL, each node of the tile is empty (already visited) with probability p_perco.
+uint64_t * Lattice_sparse::new_tile( const uint64_t key, const uint64_t h, std::mt19937_64 * engine ) {
+
+    if( 2 * ( n_tiles + 1 ) > n_groups * group )
+        grow();
+
+    bool found = false;
+    const bigInt slot = find_slot( key, h, found );
+    Group & G = table[slot / group];
+    G.key[slot % group] = key;
+    bloom_add( h );
+    n_tiles++;
+
+    uint64_t & tile = G.tile[slot % group];
+    tile = engine != NULL ? percolate_word( *engine ) : 0; //(1: empty site)
+    return &tile;
+}
+
+//------------------------------------------------------------------------------
+// Returns the slot holding 'key' (found = true), or the first empty slot where 'key' can be inserted (found = false).
+// The groups are probed one after the other, starting from the group given by the hash 'h' of the key.
+// Since the keys are never removed (until reset()), the slots of a group are filled in order, and
+// the key is not in the table once an empty slot is reached.
+// Note that the loop always ends, as the table is at most half full.
+bigInt Lattice_sparse::find_slot( const uint64_t key, const uint64_t h, bool & found ) const {
+
+    bigInt g = h & ( n_groups - 1 );
+    while( true ) {
+        const Group & G = table[g];
+        for( unsigned j = 0; j < group; j++ ) {
+            if( G.key[j] == key ) {
+                found = true;
+                return g * group + j;
+            }
+            if( G.key[j] == 0 ) {
+                found = false;
+                return g * group + j;
+            }
+        }
+        g = ( g + 1 ) & ( n_groups - 1 );
+    }
+}
+
+//------------------------------------------------------------------------------
+// Allocates an empty table of 'n' groups (and its filter).
+// The groups are aligned on 64 bytes inside 'storage', such that a group is a single cache line.
+void Lattice_sparse::allocate( const bigInt n ) {
+
+    n_groups = n;
+    storage.assign( n_groups * ( sizeof(Group) / sizeof(uint64_t) ) + 8, 0 );
+    table = (Group *) ( ( (uintptr_t) storage.data() + 63 ) & ~(uintptr_t) 63 );
+    nodes = n_groups * group * 64;
+
+    n_blocks = std::max( (bigInt) 1, n_groups * group / bloom_ratio );
+    bloom.assign( n_blocks * 8, 0 );
+
+    last_key = 0;
+    last_tile = NULL;
+}
+
+//------------------------------------------------------------------------------
+// Doubles the number of groups, and inserts the tiles again in the new table (and filter):
+void Lattice_sparse::grow() {
+
+    std::vector<uint64_t> old;
+    old.swap( storage );    //(the old groups stay in 'old')
+    const Group * old_table = table;
+    const bigInt old_n = n_groups;
+    allocate( 2 * n_groups );
+
+    bool found = false;
+    for( bigInt g = 0; g < old_n; g++ )
+        for( unsigned j = 0; j < group && old_table[g].key[j] != 0; j++ ) {
+            const uint64_t key = old_table[g].key[j];
+            const uint64_t h = hash( key );
+            const bigInt slot = find_slot( key, h, found );
+            table[slot / group].key[slot % group] = key;
+            table[slot / group].tile[slot % group] = old_table[g].tile[j];
+            bloom_add( h );
+        }
+}
+
+//------------------------------------------------------------------------------
+// Returns false if the key of hash 'h' is not in the filter (thus not in the table), true if it may be.
+// The block of the key is given by the high bits of the hash (the low bits give its group in the table),
+// and the n_probes bits in the block by 9 bits each of a second mix of the hash (see bloom_probes()),
+// such that the keys of a group (or of a block) do not share their probes.
+bool Lattice_sparse::bloom_test( const uint64_t h ) const {
+
+    const uint64_t * b = &bloom[ ( ( h >> 40 ) & ( n_blocks - 1 ) ) * 8 ];
+    const uint64_t q = bloom_probes( h );
+    for( unsigned j = 0; j < n_probes; j++ ) {
+        const unsigned p = ( q >> ( 9 * j ) ) & 511;
+        if( ( ( b[p >> 6] >> ( p & 63 ) ) & 1ULL ) == 0 )
+            return false;
+    }
+    return true;
+}
+
+//------------------------------------------------------------------------------
+// Adds the key of hash 'h' to the filter (see bloom_test()):
+void Lattice_sparse::bloom_add( const uint64_t h ) {
+
+    uint64_t * b = &bloom[ ( ( h >> 40 ) & ( n_blocks - 1 ) ) * 8 ];
+    const uint64_t q = bloom_probes( h );
+    for( unsigned j = 0; j < n_probes; j++ ) {
+        const unsigned p = ( q >> ( 9 * j ) ) & 511;
+        b[p >> 6] |= 1ULL << ( p & 63 );
+    }
+}
+
+//------------------------------------------------------------------------------
+// Checks that the coordinates of the tile holding the node 'pt' fit in a key (see get_key()).
+// It is only called when the walker enters another tile: a walker outside of the keys can not have the key of
+// the last tile (this would take a step of 2^key_bits tiles), thus checking the tiles entered is enough.
+void Lattice_sparse::check_key( const PointND & pt ) const {
+
+    if( key_bits == 64 )
+        return;
+
+    const cInt half = (cInt) 1 << ( key_bits - 1 );
+    for( unsigned i = 0; i < L_dim; i++ ) {
+        const cInt c = pt[i] >> shift;
+        if( c >= half || c <= -half )
+            throw std::runtime_error("The walker is outside of the maximum coordinate (see Lattice_sparse::check_key())");
+    }
+}
+
+//------------------------------------------------------------------------------
+// Returns the index of the node 'pt' (64 * slot of its tile + position in the tile),
+// or nodes + 1 if the node was not visited yet.
+bigInt Lattice_sparse::get_index( const PointND & pt ) const {
+
+    check_key( pt );
+    const uint64_t key = get_key( pt );
+    const uint64_t h = hash( key );
+    if( bloom_test( h ) == false )
+        return nodes + 1;
+
+    bool found = false;
+    const bigInt slot = find_slot( key, h, found );
+    const unsigned bit = get_bit( pt );
+    if( found == false || ( ( table[slot / group].tile[slot % group] >> bit ) & 1ULL ) == 0 )
+        return nodes + 1;
+    return slot * 64 + bit;
+}
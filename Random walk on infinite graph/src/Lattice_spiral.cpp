@@ -13,138 +13,37 @@
  *========================================================*/
 //------------------------------------------------------------------------------
 // Constructor:
-Lattice_spiral::Lattice_spiral(const bigInt n_preys, const bigInt N0, const double lattice_size, const unsigned dim, const double percol_value, const unsigned x_max)
-:Lattice(n_preys, N0, lattice_size, dim, percol_value, x_max) {}
+Lattice_spiral::Lattice_spiral(const bigInt n_preys, const bigInt N0, const double lattice_size, const unsigned dim, const double percol_value, const unsigned x_max, const Bit_array::Storage storage, const double growth)
+:Lattice(n_preys, N0, lattice_size, dim, percol_value, x_max, storage, growth) {}
 
 //------------------------------------------------------------------------------
-// Check if node is already visited (2D only), if not, mark it as visited.
-// We also check the node is inside the lattice, otherwise we increase its size by 2 layers (fixed value).
-bool Lattice_spiral::check_new_node(const PointND * pt) {
-
-    unsigned idx = 0;
-
-    // converts [i,j] (2-dimensional point) to spiral index:
-    idx = (bigInt) get_index( *pt );
-    
-    if( idx >= nodes ) {
-        // then index is out of the array, containing all nodes.
-        // we need reallocation of "is_visited":
-
-        const bigInt old_nodes = nodes; // save old values of nodes before increasing.
-        // increases node values by 2 'rings' or 'layers',
-        // where LDS is the number of nodes in one size (i.e. L_DIM_SIZE).
-        // thus total increase (2 layers) is:
-        const unsigned add_ = L_dim_size * 8 + 16;
-        // for generalization we can use:
-        // number of elements to add = 4 * n_layer * ( L_dim_size + n_layer )
-        // const unsigned add_ = 4 * n_layer * ( L_dim_size + n_layer )
-        // where 'n_layer' is the number of 'layers' we want to add.
-        // (a 'layer' corresponds to the nodes surrounding the current lattice, or rings).
-        
-        nodes += (bigInt) add_;
-        is_visited  = (char *) realloc( is_visited, nodes * sizeof(char) );
-        memset( &is_visited[old_nodes], '\0', (nodes - old_nodes) * sizeof(char) );
-        
-        L_dim_size += 4;
-        //or L_dim_size += n_layer*2;
-    }
-    
-    // Check whether the node at index 'idx' was previously visited or not:
-    if(is_visited[idx] == '\0') {
-        is_visited[idx] = '1';
-        return true;
-    }
-    return false;
-}
-
-//------------------------------------------------------------------------------
-// Check if node is already visited (2D only), if not, mark it as visited.
-// We also check the node is inside the lattice, otherwise we increase its size by 2 layers (fixed value).
-// (Percolation version)
-bool Lattice_spiral::check_new_node(const PointND * pt, std::mt19937_64 &engine) {
-
-    unsigned idx = 0;
-
-    //convert [i,j] (2-dimensional point) to spiral index:
-    idx = (bigInt) get_index( *pt );
-    
-    if( idx >= nodes ) {
-        // The index is out of the array, containing all nodes.
-        // reallocation of "is_visited":
-        const bigInt old_nodes = nodes; //save old values of nodes before increasing.
-        // increases node values by 2 'rings' or 'layers',
-        // where LDS is the number of nodes in one size (ie. L_DIM_SIZE).
-        // thus total increase (2 layers) is:
-        const unsigned add_ = L_dim_size * 8 + 16;
-        // for generalization we can use:
-        // number of elements to add = 4 * n_layer * ( L_dim_size + n_layer )
-        // const unsigned add_ = 4 * n_layer * ( L_dim_size + n_layer )
-        // where 'n_layer' is the number of 'layers' we want to add.
-        // (a 'layer' corresponds to the nodes surrounding the current lattice, or rings).
-        
-        nodes += (bigInt) add_;
-        is_visited  = (char *) realloc( is_visited, nodes * sizeof(char) );
-
-        // We initialize (new) "empty" nodes during the percolation:
-        percolate_new( old_nodes, nodes, engine );
-
-        L_dim_size += 4;
-    } 
-    
-    // Check whether the node at index 'idx' was previously visited or not.
-    // In the case of percolation a new site can already be marked as 'visited'
-    if(is_visited[idx] == '\0') {
-        is_visited[idx] = '1';
-        return true;
-    }
-    return false;
-}
-
-//------------------------------------------------------------------------------
-// Check if node is already visited (2D only), if not, mark it as visited.
-// We also check the node is inside the lattice, 
-// otherwise we increase its size by the required number of layers (depending on the targeted site).
-// (Jump version)
-bool Lattice_spiral::check_new_node_jump(const PointND * pt) {
-
-    unsigned idx = 0;
-    // Sets a 'margin' variable which allows for some 'room' (i.e. additional layers of nodes) for latter jumps,
-    // this prevents entering the idx >= nodes conditions 'too often'.
-    const unsigned margin = 4; 
-    unsigned n_layers = 0;
-
-    // convert [i,j] (2-dimensional point) to spiral index:
-    idx = (bigInt) get_index( *pt );
-
-    if( idx >= nodes ) {
-        // then index is out of the array, containing all nodes.
-        // we need reallocation of "is_visited":
-
-        // compute the number of new nodes to add to the lattice,
-        // that is the number of new elements to add to the 'is_visited' array.
-        // simply increase the number of layers by : max_jump_size * margin
-        n_layers = max_jump_size * margin;
-        const unsigned n_elements = 4 * n_layers * ( L_dim_size + n_layers );
-        // or, alternatively, the following function can be used:
-        // const unsigned n_elements = get_n_nodes(idx);
-        
-        // thus resize the array accordingly:
-        const bigInt old_nodes = nodes; //copy the value of nodes to old_nodes
-        nodes += n_elements;
-        
-        is_visited  = (char *) realloc( is_visited, nodes * sizeof(char) );
-        memset( &is_visited[old_nodes], '\0', (nodes - old_nodes) * sizeof(char) );
-        
-        // then accordingly increase 'L_dim_size':
-        L_dim_size = (unsigned) std::sqrt(nodes);
-    }
-    
-    // Check whether the node at index 'idx' was previously visited or not:
-    if(is_visited[idx] == '\0') {
-        is_visited[idx] = '1';
-        return true;
-    }
-    return false;
+// The walker is outside the lattice (see check_new_node()), thus we need reallocation of "is_visited":
+// we increase node values by 'n_layers' 'rings' or 'layers' (at least 'n_min', e.g. max_jump_size for the jumps),
+// (a 'layer' corresponds to the nodes surrounding the current lattice, or rings),
+// where L_dim_size grows geometrically (see Lattice::get_n_layers()).
+// The number of elements to add is then:
+// 4 * n_layers * ( L_dim_size + n_layers )
+// The new nodes are initialized to 0 (not visited), or percolated if 'engine' is not NULL.
+void Lattice_spiral::grow( const unsigned n_min, std::mt19937_64 * engine ) {
+
+    const bigInt old_nodes = nodes; //save old values of nodes before increasing.
+    const bigInt n_layers = get_n_layers( n_min );
+    
+    // The indexes of the new lattice, and of the nodes the walker can reach outside of it before the next resize
+    // (one step or one jump), must fit in their types: get_spiral_index() computes 4 * y^2 <= max_side^2 (cInt)
+    // for |y| <= max_side / 2. This is checked here, once per resize, rather than for each index at each step:
+    const double max_side = (double) L_dim_size + 2.0 * ( n_layers + max_jump_size + 1 );
+    if( max_side * max_side >= (double) std::numeric_limits<cInt>::max() )
+        throw std::runtime_error("The walker is outside of the maximum lattice node. Change the type of ''bigInt'' and ''cInt'' in ''Config_types.hpp''");
+
+    nodes += 4 * n_layers * ( L_dim_size + n_layers );
+    is_visited.resize( nodes ); //new nodes are initialized to 0 (not visited)
+
+    // We initialize (new) "empty" nodes during the percolation:
+    if( engine != NULL )
+        percolate_new( old_nodes, nodes, *engine );
+
+    L_dim_size += 2 * n_layers;
 }
 
 //------------------------------------------------------------------------------
@@ -161,26 +60,3 @@ bigInt Lattice_spiral::get_n_nodes(const bigInt idx) const {
     // then returns the number of new elements to add to the array:
     return Lds_0 * Lds_0 - L_dim_size * L_dim_size;
 }
-
-//------------------------------------------------------------------------------
-// returns index from a spiral (2D only):
-// adapted from: https://stackoverflow.com/questions/9970134/get-spiral-index-from-location
-bigInt Lattice_spiral::get_index(const PointND &pt) const {
-
-    unsigned long long int p = 0;
-
-     if( pt[1] * pt[1] >= pt[0] * pt[0] ) {
-        p = 4 * pt[1] * pt[1] - pt[1] - pt[0];
-        if ( pt[1] < pt[0] )
-            p = p - 2 * ( pt[1] - pt[0] );
-    } else {
-        p = 4 * pt[0] * pt[0] - pt[1] - pt[0];
-        if ( pt[1] < pt[0] )
-            p = p + 2 *( pt[1] - pt[0] );
-    }
-    
-    // checks whether 'p' can fit in a 'bigInt' type:
-    check_limits( p );
-    
-    return (bigInt) p;
-}
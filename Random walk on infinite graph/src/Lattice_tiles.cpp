@@ -0,0 +1,306 @@
+ /*==========================================================
+  * Lattice_tiles class, derived from Lattice class
+  * The 'lattice' is a sparse set of fixed-size tiles of nodes:
+  * 4096 nodes (1D), 64x64 nodes (2D) or 16x16x16 nodes (3D).
+  * A tile is allocated the first time the walker enters it,
+  * and a hash directory maps the coordinates of each tile to its position in 'is_visited'.
+  * Thus, the lattice never needs to be resized (and remapped) as a whole.
+  * Optionally, the tiles that were not accessed for a given number of steps ('cold' tiles, far from the walker)
+  * are compressed, and their memory is reused by the new tiles, such that the memory of very long walks is bounded
+  * by the tiles around the walker (plus the compressed tiles).
+  *========================================================*/
+#include "Lattice_tiles.hpp"
+
+/*==========================================================
+ * Lattice tiles (derived class, see 'Lattice.hpp' for base class)
+ *========================================================*/
+//------------------------------------------------------------------------------
+// Constructor:
+// The N0 nodes allocated by the base class are used as the initial pool of tiles.
+// cold_steps is the age of a cold tile, in number of steps (0: the tiles are never compressed).
+Lattice_tiles::Lattice_tiles(const bigInt n_preys, const bigInt N0, const double lattice_size, const unsigned dim, const double percol_value, const unsigned x_max, const Bit_array::Storage storage, const double growth, const bigInt cold)
+:Lattice(n_preys, N0, lattice_size, dim, percol_value, x_max, storage, growth),
+    shift{ tile_bits / dim },
+    mask{ ( (cInt) 1 << ( tile_bits / dim ) ) - 1 },
+    key_bits{ 64 / dim },
+    cold_steps{ cold },
+    next_sweep{ cold }
+{}
+
+//------------------------------------------------------------------------------
+// Reset the lattice for a new simulation: the directory is emptied, and the pool of tiles
+// is kept (with its capacity) and cleared (see Lattice::reset()).
+void Lattice_tiles::reset() {
+    Lattice::reset();
+    directory.clear();
+    n_tiles = 0;
+    has_last = false;
+
+    cold.clear();
+    free_slots.clear();
+    std::fill( last_use.begin(), last_use.end(), std::numeric_limits<bigInt>::max() );
+    clock = 0;
+    next_sweep = cold_steps;
+    n_compressed = 0;
+    n_decompressed = 0;
+    cold_bytes = 0;
+}
+
+//------------------------------------------------------------------------------
+// Getters for the compression of the cold tiles (statistics of the current simulation)
+bigInt Lattice_tiles::get_n_compressed() const {
+    return n_compressed;
+}
+
+bigInt Lattice_tiles::get_n_decompressed() const {
+    return n_decompressed;
+}
+
+bigInt Lattice_tiles::get_cold_bytes() const {
+    return cold_bytes;
+}
+
+//------------------------------------------------------------------------------
+// Check if node is already visited, if not, mark it as visited.
+// The tile holding the node is allocated if needed.
+bool Lattice_tiles::check_new_node(const PointND * pt) {
+
+    // (test_and_set() marks the node as visited and returns its previous state):
+    return is_visited.test_and_set( get_node( *pt, NULL ) ) == false;
+}
+
+//------------------------------------------------------------------------------
+// Check if node is already visited, if not, mark it as visited.
+// The tile holding the node is allocated if needed.
+// (Percolation version: the new nodes of the pool are percolated)
+bool Lattice_tiles::check_new_node(const PointND * pt, std::mt19937_64 & engine) {
+
+    // In the case of percolation a new site can already be marked as 'visited':
+    return is_visited.test_and_set( get_node( *pt, &engine ) ) == false;
+}
+
+//------------------------------------------------------------------------------
+// Check if node is already visited, if not, mark it as visited.
+// The tile holding the node is allocated if needed, whatever the length of the jump.
+// (Jump version)
+bool Lattice_tiles::check_new_node_jump(const PointND * pt) {
+    return is_visited.test_and_set( get_node( *pt, NULL ) ) == false;
+}
+
+//------------------------------------------------------------------------------
+// Returns the index of the node 'pt' in 'is_visited', and allocates its tile if needed.
+// The last tile accessed is cached, since most steps stay inside the same tile.
+// When the walker changes of tile, we also record the last access of the tiles, and compress the cold tiles (see sweep()).
+bigInt Lattice_tiles::get_node( const PointND & pt, std::mt19937_64 * engine ) {
+
+    const uint64_t key = get_key( pt );
+    clock++;
+
+    if( has_last == false || key != last_key ) {
+        if( cold_steps > 0 ) {
+            if( has_last )
+                last_use[last_slot] = clock; // the walker leaves this tile
+            if( clock >= next_sweep ) {
+                sweep();
+                next_sweep = clock + cold_steps;
+            }
+        }
+
+        auto it = directory.find( key );
+        if( it == directory.end() )
+            last_slot = new_tile( key, engine ); // first touch (or cold tile)
+        else
+            last_slot = it->second;
+
+        last_key = key;
+        has_last = true;
+        if( cold_steps > 0 )
+            last_use[last_slot] = clock;
+    }
+
+    // index of the node inside the tile (Horner's method: x + side * (y + side * z)):
+    bigInt b = 0;
+    for( unsigned i = L_dim; i-- > 0; )
+        b = ( b << shift ) | (bigInt) ( pt[i] & mask );
+
+    return ( last_slot << tile_bits ) | b;
+}
+
+//------------------------------------------------------------------------------
+// Adds a new tile (with key 'key') to the directory and returns its slot.
+// The slot of a compressed tile is used first, otherwise the next slot of the pool.
+// If the pool is full, its capacity is multiplied by the growth factor: the previous tiles keep their slots,
+// such that there is no remap of the visited nodes.
+// If 'engine' is not NULL, the new nodes of the pool are percolated.
+// If the tile was compressed (cold tile), its nodes are restored in the slot.
+bigInt Lattice_tiles::new_tile( const uint64_t key, std::mt19937_64 * engine ) {
+
+    bigInt slot = 0;
+    bool recycled = false;
+    if( free_slots.empty() == false ) {
+        slot = free_slots.back();
+        free_slots.pop_back();
+        recycled = true;
+    } else {
+        slot = n_tiles++;
+
+        if( ( n_tiles << tile_bits ) > nodes ) {
+            const bigInt old_nodes = nodes;
+            nodes = std::max( (bigInt) std::ceil( growth_factor * ( nodes >> tile_bits ) ), n_tiles ) << tile_bits;
+            is_visited.resize( nodes ); //new nodes are initialized to 0 (not visited)
+
+            if( engine != NULL )
+                percolate_new( old_nodes, nodes, *engine );
+        }
+
+        if( cold_steps > 0 && slot >= last_use.size() ) {
+            last_use.resize( nodes >> tile_bits, std::numeric_limits<bigInt>::max() );
+            slot_key.resize( nodes >> tile_bits, 0 );
+        }
+    }
+
+    auto it = cold.find( key );
+    if( it != cold.end() ) {
+        // cold tile: the walker is back
+        decompress( it->second, slot );
+        cold_bytes -= it->second.data.size() * sizeof(uint16_t);
+        cold.erase( it );
+        n_decompressed++;
+    } else if( recycled ) {
+        // the slot holds the nodes of a compressed tile: they are set to 0 again (or percolated)
+        if( engine == NULL )
+            is_visited.fill( slot << tile_bits, ( slot + 1 ) << tile_bits, false );
+        else
+            percolate_new( slot << tile_bits, ( slot + 1 ) << tile_bits, *engine );
+    }
+
+    directory[key] = slot;
+    if( cold_steps > 0 )
+        slot_key[slot] = key;
+    return slot;
+}
+
+//------------------------------------------------------------------------------
+// Compresses the tiles that were not accessed for more than 'cold_steps' steps (except the tile of the walker).
+void Lattice_tiles::sweep() {
+
+    for( bigInt slot = 0; slot < n_tiles; slot++ )
+        if( last_use[slot] != std::numeric_limits<bigInt>::max() && clock - last_use[slot] > cold_steps
+                && ( has_last == false || slot != last_slot ) )
+            compress( slot );
+}
+
+//------------------------------------------------------------------------------
+// Returns the first node >= i (in a tile of 2^tile_bits nodes 'w') whose state is 'value',
+// or 2^tile_bits if there is none:
+static bigInt next_node( const uint64_t * w, bigInt i, const bool value, const bigInt n ) {
+
+    while( i < n ) {
+        const uint64_t x = ( value ? w[i >> 6] : ~w[i >> 6] ) >> ( i & 63 );
+        if( x != 0 )
+            return std::min( i + __builtin_ctzll( x ), n );
+        i = ( i | 63 ) + 1;
+    }
+    return n;
+}
+
+//------------------------------------------------------------------------------
+// Compresses the tile in 'slot': the tile is removed from the directory, and its slot is freed.
+// The smallest container is used: the runs of visited nodes (2 values per run), the list of the visited nodes
+// (1 value per node), or the 64 words of the tile (256 values). In particular, a tile fully visited (or never visited,
+// e.g. a tile crossed by a jump) is a single run (or no run).
+void Lattice_tiles::compress( const bigInt slot ) {
+
+    const bigInt n = 1ULL << tile_bits;
+    const uint64_t * w = is_visited.data() + ( slot << ( tile_bits - 6 ) );
+
+    Cold_tile tile;
+    std::vector<uint16_t> runs;
+    bigInt count = 0;
+    for( bigInt i = next_node( w, 0, true, n ); i < n; ) {
+        const bigInt end = next_node( w, i, false, n );
+        runs.push_back( (uint16_t) i );
+        runs.push_back( (uint16_t) ( end - i - 1 ) );
+        count += end - i;
+        i = next_node( w, end, true, n );
+    }
+
+    if( runs.size() <= count && runs.size() <= n / 16 ) {
+        tile.type = Container::runs;
+        tile.data.swap( runs );
+    } else if( count <= n / 16 ) {
+        tile.type = Container::array;
+        for( bigInt i = next_node( w, 0, true, n ); i < n; i = next_node( w, i + 1, true, n ) )
+            tile.data.push_back( (uint16_t) i );
+    } else {
+        tile.type = Container::bitmap;
+        tile.data.resize( n / 16 );
+        memcpy( tile.data.data(), w, n / 8 );
+    }
+
+    cold_bytes += tile.data.size() * sizeof(uint16_t);
+    n_compressed++;
+
+    directory.erase( slot_key[slot] );
+    cold[ slot_key[slot] ] = std::move( tile );
+    last_use[slot] = std::numeric_limits<bigInt>::max();
+    free_slots.push_back( slot );
+}
+
+//------------------------------------------------------------------------------
+// Restores the nodes of a compressed tile in 'slot' (see compress()).
+void Lattice_tiles::decompress( const Cold_tile & tile, const bigInt slot ) {
+
+    const bigInt base = slot << tile_bits;
+    is_visited.fill( base, base + ( 1ULL << tile_bits ), false );
+
+    if( tile.type == Container::runs ) {
+        for( size_t r = 0; r < tile.data.size(); r += 2 )
+            is_visited.fill( base + tile.data[r], base + tile.data[r] + tile.data[r + 1] + 1, true );
+    } else if( tile.type == Container::array ) {
+        for( const uint16_t i : tile.data )
+            is_visited.set( base + i );
+    } else {
+        uint64_t w[ 1 << ( tile_bits - 6 ) ];
+        memcpy( w, tile.data.data(), sizeof(w) );
+        for( bigInt j = 0; j < ( 1ULL << ( tile_bits - 6 ) ); j++ )
+            for( uint64_t x = w[j]; x != 0; x &= x - 1 )
+                is_visited.set( base + ( j << 6 ) + __builtin_ctzll( x ) );
+    }
+}
+
+//------------------------------------------------------------------------------
+// Returns the key of the tile holding the node 'pt',
+// i.e. the coordinates of the tile packed into 64 bits (64, 32 or 21 bits per coordinate).
+uint64_t Lattice_tiles::get_key( const PointND & pt ) const {
+
+    const uint64_t key_mask = key_bits == 64 ? ~0ULL : ( 1ULL << key_bits ) - 1;
+    const cInt t_max = key_bits == 64 ? std::numeric_limits<cInt>::max() : (cInt) 1 << ( key_bits - 1 );
+
+    uint64_t key = 0;
+    for( unsigned i = 0; i < L_dim; i++ ) {
+        const cInt t = pt[i] >> shift;  // tile coordinate (arithmetic shift, i.e. floor division)
+
+        if( t >= t_max || t < -t_max )
+            throw std::runtime_error("The walker is outside of the maximum tile coordinate (see Lattice_tiles::get_key())");
+
+        key = ( i == 0 ? 0 : key << key_bits ) | ( (uint64_t) t & key_mask );
+    }
+    return key;
+}
+
+//------------------------------------------------------------------------------
+// Returns the index of the node 'pt' in 'is_visited',
+// or nodes + 1 if its tile was not allocated yet.
+bigInt Lattice_tiles::get_index( const PointND & pt ) const {
+
+    auto it = directory.find( get_key( pt ) );
+    if( it == directory.end() )
+        return nodes + 1;
+
+    bigInt b = 0;
+    for( unsigned i = L_dim; i-- > 0; )
+        b = ( b << shift ) | (bigInt) ( pt[i] & mask );
+
+    return ( it->second << tile_bits ) | b;
+}
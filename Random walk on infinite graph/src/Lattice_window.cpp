@@ -0,0 +1,172 @@
+ /*==========================================================
+  * Lattice_window class, derived from Lattice class
+  * The 'lattice' is a n-dimensional box (the 'window') [lo, hi] in each dimension, stored row by row
+  * (as in Lattice_baseconversion), where the origin of each dimension is shifted by 'lo'.
+  * Unlike the other lattices, the window is not a cube centered on the origin: it only grows on the side
+  * where the walker exits it. A drifted walker (see Step_drift) thus sweeps a 'tube' along the direction
+  * of the drift, and the memory is proportional to the volume of this tube, not to the cube around the origin.
+  *========================================================*/
+#include "Lattice_window.hpp"
+
+/*==========================================================
+ * Lattice window (derived class, see 'Lattice.hpp' for base class)
+ *========================================================*/
+//------------------------------------------------------------------------------
+// Constructor:
+// The initial window holds the nodes in [-k, k] in each dimension (see Lattice_baseconversion).
+Lattice_window::Lattice_window(const bigInt n_preys, const bigInt N0, const double lattice_size, const unsigned dim, const double percol_value, const unsigned x_max, const Bit_array::Storage storage, const double growth)
+:Lattice(n_preys, N0, lattice_size, dim, percol_value, x_max, storage, growth) {
+
+    if( dim > max_dim )
+        throw std::runtime_error("Lattice_window: the dimension of the lattice must be in [1, 3]");
+
+    const cInt k = (cInt) (L_dim_size-1) / 2;
+    nodes = 1;
+    for( unsigned i = 0; i < L_dim; i++ ) {
+        lo[i] = -k;
+        hi[i] = k;
+        side[i] = 2 * k + 1;
+        nodes *= side[i];
+    }
+    is_visited.resize( nodes );
+}
+
+//------------------------------------------------------------------------------
+// The walker ('pt') is outside the window, thus we grow the window on the side(s) where the walker exited.
+// In each such dimension, the side of the window is multiplied by the growth factor (at least 'n_min' nodes are added
+// beyond the walker), and the other sides are unchanged.
+// The visited nodes are moved in place, row by row, from the last row to the first one (see
+// Lattice_baseconversion::resize_lattice_inplace(): the new offset of a row is never smaller than its old offset).
+// The new nodes are set to 0 (not visited), or percolated if 'engine' is not NULL.
+void Lattice_window::resize_window( const PointND & pt, const unsigned n_min, std::mt19937_64 * engine ) {
+
+    cInt new_lo[max_dim] = { 0, 0, 0 }, new_hi[max_dim] = { 0, 0, 0 };
+    bigInt new_side[max_dim] = { 1, 1, 1 };
+    bigInt new_nodes_count = 1;
+    double max_nodes = 1.0;     //number of nodes of the new window, and of the nodes the walker can reach outside of it
+    for( unsigned i = 0; i < L_dim; i++ ) {
+        const cInt n_add = (cInt) std::max( (bigInt) n_min, (bigInt) std::ceil( ( growth_factor - 1.0 ) * side[i] ) );
+        new_lo[i] = pt[i] < lo[i] ? pt[i] - n_add : lo[i];
+        new_hi[i] = pt[i] > hi[i] ? pt[i] + n_add : hi[i];
+        new_side[i] = new_hi[i] - new_lo[i] + 1;
+        new_nodes_count *= new_side[i];
+        max_nodes *= (double) new_side[i] + 2.0 * ( max_jump_size + 1 );
+    }
+
+    // The indexes of the new window, and of the nodes the walker can reach outside of it before the next resize
+    // (one step or one jump), must fit in a bigInt: this is checked here, once per resize, rather than for each index:
+    if( max_nodes >= (double) std::numeric_limits<bigInt>::max() )
+        throw std::runtime_error("The walker is outside of the maximum lattice node. Change the type of ''bigInt'' in ''Config_types.hpp''");
+
+    const bigInt old_nodes = nodes;
+    nodes = new_nodes_count;
+    is_visited.resize( nodes );
+
+    // offsets of the old window inside the new one:
+    const bigInt dx = lo[0] - new_lo[0];
+    const bigInt dy = L_dim > 1 ? lo[1] - new_lo[1] : 0;
+    const bigInt dz = L_dim > 2 ? lo[2] - new_lo[2] : 0;
+
+    // we move the rows (y, z), from the last one to the first one.
+    // 'next_start' is the start of the previous row moved (i.e. the end of the current gap):
+    bigInt src = old_nodes;
+    bigInt next_start = nodes;
+    for( bigInt z = side[2]; z-- > 0; )
+        for( bigInt y = side[1]; y-- > 0; ) {
+            src -= side[0];
+            const bigInt dst = ( ( y + dy ) + new_side[1] * ( z + dz ) ) * new_side[0] + dx;
+
+            // without percolation, an empty row (no visited node) is not moved:
+            // it is merged into the gap, which is filled with 0 at once with the next row moved.
+            if( engine == NULL && is_visited.any( src, src + side[0] ) == false )
+                continue;
+
+            is_visited.move( dst, src, side[0] );
+            new_nodes( dst + side[0], next_start, engine );
+            next_start = dst;
+        }
+    new_nodes( 0, next_start, engine );
+
+    for( unsigned i = 0; i < L_dim; i++ ) {
+        lo[i] = new_lo[i];
+        hi[i] = new_hi[i];
+        side[i] = new_side[i];
+    }
+
+    // (L_dim_size is the side of a cube with the same number of nodes, see Config_params::get_N0_from_side())
+    L_dim_size = L_dim == 1 ? nodes : (bigInt) std::round( std::pow( (double) nodes, 1.0 / L_dim ) );
+}
+
+//------------------------------------------------------------------------------
+// Initializes the new nodes in [start, end) (added when resizing the window):
+// they are either not visited (0), or percolated if 'engine' is not NULL.
+void Lattice_window::new_nodes( const bigInt start, const bigInt end, std::mt19937_64 * engine ) {
+    if( engine == NULL )
+        is_visited.fill( start, end, false );
+    else
+        percolate_new( start, end, *engine );
+}
+
+//------------------------------------------------------------------------------
+// Check if node is already visited, if not, mark it as visited.
+// We also check the node is inside the window, otherwise we grow the window on the side of the walker.
+bool Lattice_window::check_new_node(const PointND * pt) {
+
+    bigInt idx = get_index( *pt );
+    if( idx >= nodes ) {
+        resize_window( *pt, 1, NULL );
+        idx = get_index( *pt );
+    }
+
+    // (test_and_set() marks the node as visited and returns its previous state):
+    return is_visited.test_and_set( idx ) == false;
+}
+
+//------------------------------------------------------------------------------
+// Check if node is already visited, if not, mark it as visited.
+// We also check the node is inside the window, otherwise we grow the window on the side of the walker.
+// (Percolation version: only the new nodes are percolated)
+bool Lattice_window::check_new_node(const PointND * pt, std::mt19937_64 & engine) {
+
+    bigInt idx = get_index( *pt );
+    if( idx >= nodes ) {
+        resize_window( *pt, 1, &engine );
+        idx = get_index( *pt );
+    }
+
+    // In the case of percolation a new site can already be marked as 'visited':
+    return is_visited.test_and_set( idx ) == false;
+}
+
+//------------------------------------------------------------------------------
+// Check if node is already visited, if not, mark it as visited.
+// We also check the node is inside the window, otherwise we grow the window on the side of the walker,
+// by at least max_jump_size nodes.
+// (Jump version)
+bool Lattice_window::check_new_node_jump(const PointND * pt) {
+
+    bigInt idx = get_index( *pt );
+    if( idx >= nodes ) {
+        resize_window( *pt, max_jump_size, NULL );
+        idx = get_index( *pt );
+    }
+
+    return is_visited.test_and_set( idx ) == false;
+}
+
+//------------------------------------------------------------------------------
+// Returns the index of a n-Dimensional position in the window,
+// or nodes + 1 if the position is outside the window:
+// index = (x - lo[0]) + side[0] * ( (y - lo[1]) + side[1] * (z - lo[2]) )
+bigInt Lattice_window::get_index( const PointND & pt ) const {
+
+    unsigned long long int p = 0;
+    for( unsigned i = L_dim; i-- > 0; ) {
+        if( pt[i] < lo[i] || pt[i] > hi[i] )
+            return nodes + 1;   // notify check_new_node() that the walker is outside the window.
+
+        p = p * side[i] + (unsigned long long int) ( pt[i] - lo[i] );
+    }
+
+    return (bigInt) p;
+}
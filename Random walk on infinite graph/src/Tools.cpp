@@ -52,6 +52,10 @@ bigInt Tools::json_to_bigInt(const nlohmann::json& j) {
         return (bigInt) std::stoull( s );
 }
 
+std::string Tools::json_to_string(const nlohmann::json& j) {
+    return j.get<nlohmann::json::string_t>();
+}
+
 // Check for any '-' sign in the (string) JSON expression:
 bool Tools::check_sign(const std::string S) {
     std::size_t found = S.find("-");
@@ -11,14 +11,12 @@
 //------------------------------------------------------------------------------
 // Constructor:
 Walker::Walker( const double cur_speed, const double cur_handling, const unsigned L_dim )
-    :loc{ new PointND( L_dim ) }, speed{ cur_speed }, handling_time{ cur_handling }
+    :loc{ L_dim }, speed{ cur_speed }, handling_time{ cur_handling }
 {}
 
 //------------------------------------------------------------------------------
 // Distructor
-Walker::~Walker() {
-    delete( loc );
-};
+Walker::~Walker() {};
 
 //------------------------------------------------------------------------------
 // returns walker's speed:
@@ -36,9 +34,10 @@ double Walker::get_handling_time() const {
 
 //------------------------------------------------------------------------------
 // Move the walker (one step):
-void Walker::move( PointND * new_loc ) {
-    //randomly increases or decreases an indice in one random dimension:
-    loc = new_loc;
+void Walker::move( const PointND & new_loc ) {
+    //jumps to the location 'new_loc':
+    for( unsigned i = 0; i < loc.n_dim(); i++ )
+        loc[i] = new_loc[i];
 }
 
 //------------------------------------------------------------------------------
@@ -54,9 +53,9 @@ void Walker::move( const int r_dim, const int r_dir ) {
     // r_dir is the direction 
     // randomly increases or decreases an indice in one random dimension:
     if( r_dir == 0 )
-        (*loc)[r_dim] += -1;
+        loc[r_dim] += -1;
     else
-        (*loc)[r_dim] += 1;
+        loc[r_dim] += 1;
 }
 
 //------------------------------------------------------------------------------
@@ -64,25 +63,10 @@ void Walker::move( const int r_dim, const int r_dir ) {
 void Walker::move( const int r_dim, const int r_dir, const unsigned step ) {
     //randomly increases or decreases an indice in one random dimension with step magnitude 'step':
     if( r_dir == 0 ) {
-        (*loc)[r_dim] += -(cInt) step;
+        loc[r_dim] += -(cInt) step;
     }
     else
-        (*loc)[r_dim] += step;
-}
-
-//------------------------------------------------------------------------------
-// Move the walker (one step, with drift):
-void Walker::move( const int r_dim, const int r_dir, const char is_drift ) {
-
-    if(is_drift == '0') { //NO DRIFT
-        //randomly increases or decreases an indice in one random dimension:
-        if( r_dir == 0 )
-            (*loc)[r_dim] += -1;
-        else
-            (*loc)[r_dim] += 1;
-    } else { //DRIFTING in the (fist) right direction (arbitrary)
-        (*loc)[0] += 1;
-    }
+        loc[r_dim] += step;
 }
 
 
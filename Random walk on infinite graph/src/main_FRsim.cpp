@@ -22,12 +22,9 @@
 #include <iomanip>
 #include <chrono>
 #include <sys/stat.h>
-#include "FRsim.hpp"
+#include <omp.h>
 #include "FRsim_base.hpp"
-#include "FRsim_drift.hpp"
-#include "FRsim_jumps.hpp"
-#include "FRsim_memory.hpp"
-#include "FRsim_perco.hpp"
+#include "FRsim_kernel.hpp"
 #include "Tools.hpp"
 #include "PointND.hpp"
 #include "Config_params.hpp"
@@ -37,17 +34,19 @@ using namespace std::chrono;
 namespace
 {
     void print_usage() {
-        std::cout << "Usage is: ./frsim ./Config_file.json -perturbation" << std::endl;
+        std::cout << "Usage is: ./frsim ./Config_file.json -perturbation(s)" << std::endl;
         std::cout << "Where 'Config_file.json' is the JSON configuration file" << std::endl;
-        std::cout << "and '-perturbation' is one of the following perturbation:" << std::endl;
+        std::cout << "and '-perturbation(s)' is none, one or several of the following perturbations:" << std::endl;
         std::cout << "-drift : random walk with drift" << std::endl;
         std::cout << "-memory : random walk with memory (past site only)" << std::endl;
         std::cout << "-jumps : random walk with jumps" << std::endl;
-        std::cout << "-percolation : random walk in a percolated lattice" << std::endl << std::endl;
+        std::cout << "-percolation : random walk in a percolated lattice" << std::endl;
+        std::cout << "(-drift and -jumps can not be combined)" << std::endl << std::endl;
         std::cout << "Examples:" << std::endl;
         std::cout << "./frsim ./Config.Json : typical random walk using 'Config.Json' without any perturbation" << std::endl;
         std::cout << "./frsim ./Config.Json -memory : random walk using 'Config.Json' and a memory" << std::endl;
         std::cout << "./frsim ./Config.Json -drift : random walk using 'Config.Json' with a drift" << std::endl;
+        std::cout << "./frsim ./Config.Json -drift -percolation : random walk using 'Config.Json' with a drift, in a percolated lattice" << std::endl;
     }
 }
 
@@ -61,7 +60,7 @@ int main( int argc, char *argv[] ) {
     
     std::cout << "==== Random walks - FRsim (V1) ====" << std::endl;
     
-    if( argc < 2 || argc > 3 ) {
+    if( argc < 2 || argc > 6 ) {
         std::cerr << "Error: wrong number of arguments." << std::endl;
         std::cerr << "Type /frsim -help for usage." << std::endl;
         exit(EXIT_FAILURE);
@@ -92,18 +91,19 @@ int main( int argc, char *argv[] ) {
         exit(EXIT_FAILURE);
     }
     
-    // then check for additional options, if any:
-    int what_perturb = 0; // =0 means that this is a standard random walk.
-    if( argc == 3 ) {
+    // then check for additional options, if any.
+    // The perturbations are flags (see Config_types.hpp), which can be combined:
+    unsigned perturb = 0; // =0 means that this is a standard random walk.
+    for( int k = 2; k < argc; k++ ) {
         // read the additional option
-        if( args[2] == "-drift" )
-            what_perturb = 1; // 1 is a drifted random walk
-        else if( args[2] == "-jumps" )
-            what_perturb = 2; // 2 is a random walk with jumps
-        else if( args[2] == "-memory" )
-            what_perturb = 3; // 3 is a random walk with memory
-        else if( args[2] == "-percolation" )
-            what_perturb = 4; // 4 is a standard random walk in a percolated lattice
+        if( args[k] == "-drift" )
+            perturb |= perturb_drift; // drifted random walk
+        else if( args[k] == "-jumps" )
+            perturb |= perturb_jumps; // random walk with jumps
+        else if( args[k] == "-memory" )
+            perturb |= perturb_memory; // random walk with memory
+        else if( args[k] == "-percolation" )
+            perturb |= perturb_percolation; // random walk in a percolated lattice
         else {
             std::cerr << "Error: wrong option." << std::endl;
             std::cerr << "Type /frsim -help for usage." << std::endl;
@@ -111,6 +111,13 @@ int main( int argc, char *argv[] ) {
         }
     }
     
+    // the drift and the jumps are both a type of step (see FRsim_kernel.hpp):
+    if( ( perturb & perturb_drift ) != 0 && ( perturb & perturb_jumps ) != 0 ) {
+        std::cerr << "Error: -drift and -jumps can not be combined." << std::endl;
+        std::cerr << "Type /frsim -help for usage." << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    
     std::cout << "loading/parsing configuration file \"" << argv[1] << "\"...";
     nlohmann::json JSON_parse; //structure that will hold all parameters for each simulation:
     Tools().loadJSON(in, JSON_parse); //load to 'JSON_parse'
@@ -129,6 +136,54 @@ int main( int argc, char *argv[] ) {
         for(unsigned i=0; i < JSON_parse["Xs"].size(); i++)
             V.push_back( Tools().json_to_bigInt( JSON_parse["Xs"].at(i) ) );
     
+    // ---- Collect optional parameters ----
+    // lattice engine (the default engine is chosen depending on the dimension, see below):
+    std::string lattice_engine = "default";
+    if( JSON_parse.find("lattice") != JSON_parse.end() )
+        lattice_engine = Tools().json_to_string( JSON_parse["lattice"] );
+    
+    // storage of the visited nodes ("heap" or "reserve", see 'Bit_array.hpp'):
+    std::string lattice_memory = "heap";
+    if( JSON_parse.find("lattice_memory") != JSON_parse.end() )
+        lattice_memory = Tools().json_to_string( JSON_parse["lattice_memory"] );
+    
+    // sizing of the lattice (see Config_params::get_N0() and Lattice::get_n_layers()):
+    bigInt lattice_N0 = 0; // 0: N0 is predicted from the range of the walk
+    if( JSON_parse.find("lattice_N0") != JSON_parse.end() )
+        lattice_N0 = Tools().json_to_bigInt( JSON_parse["lattice_N0"] );
+    
+    double lattice_range = 3.0;
+    if( JSON_parse.find("lattice_range") != JSON_parse.end() )
+        lattice_range = Tools().json_to_double( JSON_parse["lattice_range"] );
+    
+    double lattice_growth = 1.5;
+    if( JSON_parse.find("lattice_growth") != JSON_parse.end() )
+        lattice_growth = Tools().json_to_double( JSON_parse["lattice_growth"] );
+    
+    double lattice_max_mb = 1024.0;
+    if( JSON_parse.find("lattice_max_mb") != JSON_parse.end() )
+        lattice_max_mb = Tools().json_to_double( JSON_parse["lattice_max_mb"] );
+    
+    // compression of the cold tiles ('tiles' lattice, see Lattice_tiles):
+    bigInt lattice_cold_steps = 0; // 0: the tiles are never compressed
+    if( JSON_parse.find("lattice_cold_steps") != JSON_parse.end() )
+        lattice_cold_steps = Tools().json_to_bigInt( JSON_parse["lattice_cold_steps"] );
+    
+    // directory of the lattice files ('file' storage, see 'Bit_array.hpp'):
+    std::string lattice_scratch_dir = "/tmp";
+    if( JSON_parse.find("lattice_scratch_dir") != JSON_parse.end() )
+        lattice_scratch_dir = Tools().json_to_string( JSON_parse["lattice_scratch_dir"] );
+    
+    // lazy percolation: the empty nodes are given by a hash of their coordinates (see Landscape_lazy):
+    bigInt percolation_seed = 0; // 0: the lattice is percolated at start
+    if( JSON_parse.find("percolation_seed") != JSON_parse.end() )
+        percolation_seed = Tools().json_to_bigInt( JSON_parse["percolation_seed"] );
+    
+    // percolated landscape of each simulation ("independent"), or shared by the simulations of a value of Xs ("shared"):
+    std::string percolation_landscape = "independent";
+    if( JSON_parse.find("percolation_landscape") != JSON_parse.end() )
+        percolation_landscape = Tools().json_to_string( JSON_parse["percolation_landscape"] );
+    
     // ---- Assign to config ----
     // note:
     // V is passed by value and the lifetime of V is in the main() function,
@@ -147,7 +202,17 @@ int main( int argc, char *argv[] ) {
             Tools().json_to_double( JSON_parse["power_law_xmax"] ),
             Tools().json_to_double( JSON_parse["power_law_gamma"] ),
             Tools().json_to_double( JSON_parse["p_perco"] ),
-            V );
+            V,
+            lattice_engine,
+            lattice_memory,
+            lattice_N0,
+            lattice_range,
+            lattice_growth,
+            lattice_max_mb,
+            lattice_cold_steps,
+            lattice_scratch_dir,
+            percolation_seed,
+            percolation_landscape );
     
     std::cout << "checking parameters values...";
     config.assert_params_values(); //assert each parameter value is in the expected range of values.
@@ -172,14 +237,62 @@ int main( int argc, char *argv[] ) {
     
     // Init lattice (depending on dimension) ------------------
     bigInt n_nodes = 0; //number of nodes required in the configfile
-    bigInt N0 = 0; //number of nodes in the lattice at the start of the simulation (see 'config.hpp')
+    bigInt N0 = 0; //number of nodes in the lattice at the start of the simulation (see 'Config_params.hpp')
+    // largest side (L_dim_size) of the lattice observed at the end of the previous simulations, for each value of Xs.
+    // The next simulations start with (at least) this size, such that they are rarely resized:
+    std::vector<bigInt> learned_side( N_nodeconf, 0 );
+    // ('hugepage' storage) largest lattice, and the bytes of this lattice actually backed by huge pages:
+    bigInt max_lattice_bytes = 0, max_huge_bytes = 0;
+    // ('tiles' lattice) number of tiles compressed and decompressed, and largest size of the compressed tiles:
+    bigInt n_compressed = 0, n_decompressed = 0, max_cold_bytes = 0;
     
     // config.assert_params_values() are ok, we can now convert to (unsigned) type:
     const unsigned x_max = (unsigned) config.x_max_t;
     const unsigned x_min = (unsigned) config.x_min_t;
     std::shared_ptr<Power_law> PL{ std::make_shared<Power_law>( x_min, x_max, config.gamma ) };
     
-#pragma omp parallel num_threads( config.n_cores )
+    // lattice engine (the default engine depends on the walk, see Config_params::get_lattice()):
+    const std::string lattice = config.get_lattice( perturb );
+    
+    // config.assert_params_values() are ok, we can now convert the storage of the lattice
+    // (the engines with their own storage ignore it, see Config_params::uses_lattice_memory()):
+    const bool has_bit_array = Config_params::uses_lattice_memory( lattice );
+    if( has_bit_array == false && config.lattice_memory != "heap" )
+        std::cerr << "Warning: lattice_memory = " << config.lattice_memory << " does not apply to the lattice engine "
+                  << lattice << " (its nodes are not stored in a bit array), the heap is used." << std::endl;
+    const Bit_array::Storage storage = ( has_bit_array == false || config.lattice_memory == "heap" ) ? Bit_array::Storage::heap
+        : ( config.lattice_memory == "reserve" ? Bit_array::Storage::reserve
+        : ( config.lattice_memory == "hugepage" ? Bit_array::Storage::hugepage : Bit_array::Storage::file ) );
+    Bit_array::set_scratch_dir( config.lattice_scratch_dir );
+    
+    // A shared landscape is the lazy percolation (see Landscape_lazy) with the same seed for all the simulations of a value
+    // of Xs: the landscape is a function of the coordinates of the nodes (read-only, and shared by the threads without
+    // any memory), and each simulation only holds the nodes visited by its walker (its lattice).
+    // The percolated walks with jumps are also lazy, since the lattices do not percolate the nodes added by a jump.
+    // If no seed is given, a random seed is drawn (and printed, such that the landscapes can be used again):
+    bigInt landscape_seed = config.percolation_seed;
+    const bool is_percolated = ( perturb & perturb_percolation ) != 0;
+    const bool shared_landscape = is_percolated && config.percolation_landscape == "shared";
+    const bool lazy_jumps = is_percolated && ( perturb & perturb_jumps ) != 0;
+    if( ( shared_landscape || lazy_jumps ) && landscape_seed == 0 ) {
+        std::random_device seed;
+        landscape_seed = ( ( (bigInt) seed() << 32 ) | seed() ) >> 1 | 1; //(not 0, and not overflowing when adding Xs index)
+        std::cout << "percolation seed = " << landscape_seed << ( shared_landscape ? " (shared landscapes)" : " (lazy percolation)" ) << std::endl;
+    }
+    
+    // the nodes of a lattice percolated at start can not be reused by the next simulations
+    // (unlike the lazy percolation, where the lattice only holds the visited nodes, see Landscape_lazy):
+    const bool percolate_at_start = is_percolated && landscape_seed == 0;
+    
+    // Each thread runs simulations (no more threads than simulations), and the cores left are shared by the threads
+    // to percolate their lattices (nested parallel region, see Lattice::percolate_new()), such that at most n_cores
+    // threads run at once (e.g. a single simulation on a large percolated lattice uses every core to percolate it):
+    const unsigned n_threads = std::max( 1u, std::min( config.n_cores, config.n_sims ) );
+    Lattice::set_percolate_threads( config.n_cores / n_threads );
+    if( config.n_cores / n_threads > 1 )
+        omp_set_max_active_levels( 2 );
+    
+#pragma omp parallel num_threads( n_threads )
     {
         for(unsigned i=0; i < N_nodeconf; i++) {
             
@@ -191,14 +304,14 @@ int main( int argc, char *argv[] ) {
             n_nodes = config.N0s.at(i);
             
             // Assign N0 (the initial/starting number of nodes in the lattice)
-            // depending on the dimension L_dim and the number of preys 'n_nodes'
-            // see 'config.hpp' fo the definition of N0_1D, N0_2D and N0_3D:
-            if( config.L_dim == 1 )
-                N0 = N0_1D;
-            else if ( config.L_dim == 2 )
-                N0 = N0_2D;
-            else if ( config.L_dim == 3 )
-                N0 = N0_3D;
+            // depending on the dimension L_dim, the number of preys 'n_nodes' and the type of walk
+            // (see Config_params::get_N0()):
+            N0 = config.get_N0( n_nodes, perturb );
+            
+            // Each thread owns a lattice for this value of Xs: it is created by the first simulation of the thread,
+            // then reset by the next ones (see Lattice::reset()), such that it keeps its grown size and memory
+            // (no allocation, nor clearing of the whole lattice, for each simulation):
+            std::shared_ptr<Lattice> L = NULL;
             
 #pragma omp for
             for(unsigned n_s=0; n_s < config.n_sims; n_s++) {
@@ -219,39 +332,58 @@ int main( int argc, char *argv[] ) {
                 bigInt cpt = 0; //set the number of discovered preys / new sites
                         
                 // Initialize lattice ------------------
-                std::shared_ptr<Lattice> L = NULL;
+                // (a lattice percolated at start is created again for each simulation: all its nodes are percolated again anyway,
+                // and it must not keep the size grown by the previous walkers, see Config_params::get_N0())
+                if( L != NULL && percolate_at_start == false )
+                    L->reset();
+                else {
+                    // start with the largest lattice observed so far (unless N0 is given in the configuration file,
+                    // or the lattice is percolated, see Config_params::get_N0()):
+                    bigInt N0_sim = N0;
+                    if( config.lattice_N0 == 0 && percolate_at_start == false ) {
+#pragma omp critical
+                        N0_sim = std::max( N0, config.get_N0_from_side( learned_side[i] ) );
+                    }
                         
-                if( config.L_dim == 2 )
-                    // if dimension == 2, then we implement a spiral indexation, which is faster
-                    L = std::make_shared<Lattice_spiral>(n_nodes, N0, config.L_size, config.L_dim, config.p_perco, x_max);
-                else
-                    // Otherwise we use the standard lattice
-                    L = std::make_shared<Lattice_baseconversion>(n_nodes, N0, config.L_size, config.L_dim, config.p_perco, x_max);
+                    if( lattice == "bitboard" )
+                        // blocks of 64 nodes packed into words (1, 2 or 3 dimensions)
+                        L = std::make_shared<Lattice_bitboard>(n_nodes, N0_sim, config.L_size, config.L_dim, config.p_perco, x_max, storage, config.lattice_growth);
+                    else if( lattice == "tiles" )
+                        // sparse tiles of 4096 nodes, allocated on first touch (1, 2 or 3 dimensions)
+                        L = std::make_shared<Lattice_tiles>(n_nodes, N0_sim, config.L_size, config.L_dim, config.p_perco, x_max, storage, config.lattice_growth, config.lattice_cold_steps);
+                    else if( lattice == "morton" )
+                        // Z-order (Morton) indexation, the lattice grows by appending nodes (1, 2 or 3 dimensions)
+                        L = std::make_shared<Lattice_morton>(n_nodes, N0_sim, config.L_size, config.L_dim, config.p_perco, x_max, storage, config.lattice_growth);
+                    else if( lattice == "hashset" )
+                        // hash set of the visited nodes, the memory does not depend on the extent of the walk (1, 2 or 3 dimensions)
+                        L = std::make_shared<Lattice_hashset>(n_nodes, N0_sim, config.L_size, config.L_dim, config.p_perco, x_max, storage, config.lattice_growth);
+                    else if( lattice == "shell" )
+                        // shell (or 'onion') indexation, the lattice grows by appending shells (1, 2 or 3 dimensions)
+                        L = std::make_shared<Lattice_shell>(n_nodes, N0_sim, config.L_size, config.L_dim, config.p_perco, x_max, storage, config.lattice_growth);
+                    else if( lattice == "window" )
+                        // window growing on the side where the walker exits (1, 2 or 3 dimensions)
+                        L = std::make_shared<Lattice_window>(n_nodes, N0_sim, config.L_size, config.L_dim, config.p_perco, x_max, storage, config.lattice_growth);
+                    else if( lattice == "sparse" )
+                        // hash of tiles of 64 nodes behind a Bloom filter, the memory grows with the visited nodes (1, 2 or 3 dimensions)
+                        L = std::make_shared<Lattice_sparse>(n_nodes, N0_sim, config.L_size, config.L_dim, config.p_perco, x_max, storage, config.lattice_growth);
+                    else if( lattice == "range" )
+                        // interval of the visited nodes, walks with neighbour steps (1 dimension)
+                        L = std::make_shared<Lattice_range>(n_nodes, N0_sim, config.L_size, config.L_dim, config.p_perco, x_max, storage, config.lattice_growth);
+                    else if( lattice == "spiral" )
+                        // if dimension == 2, then we implement a spiral indexation, which is faster
+                        L = std::make_shared<Lattice_spiral>(n_nodes, N0_sim, config.L_size, config.L_dim, config.p_perco, x_max, storage, config.lattice_growth);
+                    else
+                        // Otherwise we use the standard lattice
+                        L = std::make_shared<Lattice_baseconversion>(n_nodes, N0_sim, config.L_size, config.L_dim, config.p_perco, x_max, storage, config.lattice_growth);
+                }
                         
                 // Create the simulation ------------------
-                FRsim_base * sim;
-                        
-                // Encoding is the following:
-                switch( what_perturb ) {
-                    case 0 : { // 0 : standard random walk (no perturbation)
-                        sim = new FRsim(n_nodes, config.end_time, L, W);
-                        break; }
-                    case 1 : { // 1 is a drifted random walk
-                        sim = new FRsim_drift(n_nodes, config.end_time, L, W, config.p_drift);
-                        break; }
-                    case 2 : { // 2 is a random walk with jumps
-                        sim = new FRsim_jumps(n_nodes, config.end_time, L, W, PL);
-                        break; }
-                    case 3 : { // 3 is a random walk with memory
-                        sim = new FRsim_memory(n_nodes, config.end_time, L, W);
-                        break; }
-                    case 4 : { // 4 is a standard random walk in a percolated lattice
-                        sim = new FRsim_perco(n_nodes, config.end_time, L, W, config.p_perco);
-                        break; }
-                    default: { //otherwise: standard random walk (no perturbation)
-                        sim = new FRsim(n_nodes, config.end_time, L, W);
-                        break; }
-                    }
+                // (one walk per combination of the perturbations, see FRsim_kernel.hpp).
+                // The landscape of the lazy percolation is given by the seed and the number of the simulation,
+                // or only by the value of Xs if the landscape is shared:
+                FRsim_base * sim = make_FRsim(perturb, n_nodes, config.end_time, L, W, config.p_drift, PL,
+                        landscape_seed == 0 ? 0
+                        : ( shared_landscape ? landscape_seed + i : landscape_seed + (bigInt) i * config.n_sims + n_s ));
                 
                 // Run the simulation (depending on the simulation type) ------------------
                 sim->run(cpt);
@@ -262,6 +394,17 @@ int main( int argc, char *argv[] ) {
                 {
                     sum_nnodes.push_back(n_nodes); //total number of nodes (ie. preys)
                     sum_nvisited.push_back(cpt);   //total number of visited nodes (ie. interactions)
+                    learned_side[i] = std::max( learned_side[i], L->get_L_dim_size() );
+                    if( storage == Bit_array::Storage::hugepage && L->get_memory_bytes() > max_lattice_bytes ) {
+                        max_lattice_bytes = L->get_memory_bytes();
+                        max_huge_bytes = L->get_huge_page_bytes();
+                    }
+                    if( config.lattice_cold_steps > 0 && lattice == "tiles" ) {
+                        const std::shared_ptr<Lattice_tiles> T = std::dynamic_pointer_cast<Lattice_tiles>( L );
+                        n_compressed += T->get_n_compressed();
+                        n_decompressed += T->get_n_decompressed();
+                        max_cold_bytes = std::max( max_cold_bytes, T->get_cold_bytes() );
+                    }
                 }
                 
                 // Delete current simulation  ------------------
@@ -305,6 +448,16 @@ int main( int argc, char *argv[] ) {
         exit(EXIT_FAILURE);
     }
     
+    // Report whether huge pages were actually obtained (see 'Bit_array.hpp'):
+    if( storage == Bit_array::Storage::hugepage )
+        std::cout << "huge pages: " << max_huge_bytes / ( 1 << 20 ) << " MB of the largest lattice ("
+                  << max_lattice_bytes / ( 1 << 20 ) << " MB)" << std::endl;
+    
+    // Report the compression of the cold tiles (see 'Lattice_tiles.hpp'):
+    if( config.lattice_cold_steps > 0 && lattice == "tiles" )
+        std::cout << "cold tiles: " << n_compressed << " compressed, " << n_decompressed << " decompressed, "
+                  << max_cold_bytes / 1024 << " kB compressed (largest)" << std::endl;
+    
     high_resolution_clock::time_point t2 = high_resolution_clock::now();
     auto duration = duration_cast<seconds>( t2 - t1 ).count();
     std::cout << "Duration is: " << duration << " seconds\n";